@@ -7,18 +7,30 @@
 #include "opl.h"
 #include "instruments.h"
 #include "screen.h"
-
-// State memory for all 9 channels
-ArpState ch_arp[9];
-PortamentoState ch_porta[9];
-VolumeSlideState ch_volslide[9];
-VibratoState ch_vibrato[9];
-NoteCutState ch_notecut[9];
-NoteDelayState ch_notedelay[9];
-RetriggerState ch_retrigger[9];
-TremoloState ch_tremolo[9];
-FinePitchState ch_finepitch[9];
-GenState ch_generator[9];
+#include "engine.h"
+#include "lfo.h"
+
+// State memory for all 9 channels, one array per field
+ArpState ch_arp;
+PortamentoState ch_porta;
+VolumeSlideState ch_volslide;
+VibratoState ch_vibrato;
+NoteCutState ch_notecut;
+NoteDelayState ch_notedelay;
+RetriggerState ch_retrigger;
+TremoloState ch_tremolo;
+FinePitchState ch_finepitch;
+GenState ch_generator;
+uint16_t ch_fx[9];
+uint16_t fx_row_start = 0;
+
+PitchState ch_pitch;
+uint16_t pitch_dirty = 0;
+uint16_t pitch_key_on = 0;
+static uint16_t pitch_rekey = 0;  // Strikes that only need the key bit
+
+VolumeState ch_volume;
+uint16_t volume_dirty = 0;
 
 // Arpeggio tick lookup table (frames at 150 BPM baseline: 6 frames/row)
 // Musical intervals: 3=1row, 7=2rows, 11=4rows(1beat), 15=16rows(1bar)
@@ -26,6 +38,41 @@ const uint8_t arp_tick_lut[16] = {
     1, 2, 3, 6, 9, 12, 15, 12, 18, 21, 24, 24, 36, 54, 72, 96
 };
 
+// Tempo-scaled effect timings, indexed by the effect's T/D nibble.
+// Rebuilt by effects_update_tempo() whenever the BPM changes, so the
+// parse handlers never multiply or divide.
+static uint16_t arp_target_fp[16];   // Arp step length (8.8 frames)
+static uint16_t delay_target_fp[16]; // Retrigger/echo delay (8.8 frames), 0 = 3 ticks
+static uint16_t cut_tick_lut[16];    // Note cut tick, 0 = 1 tick
+static uint16_t gen_tick_lut[16];    // Generator step length in ticks
+static uint16_t lfo_step_lut[16];    // LFO phase step per frame, by rate
+
+void effects_update_tempo(void) {
+    uint16_t tpr = seq.ticks_per_row_fp;
+    // One logical "tick" duration in the current tempo, in frames. The
+    // fp timers advance ENGINE_TICK_FP per engine tick.
+    uint16_t one_tick_fp = tpr / (6 << ENGINE_TICK_SHIFT);
+
+    for (uint8_t i = 0; i < 16; i++) {
+        uint16_t base_frames = arp_tick_lut[i];
+
+        // target = base_frames * (current_row_duration / 6)
+        arp_target_fp[i] = (uint16_t)(((uint32_t)base_frames * tpr) / (6 << ENGINE_TICK_SHIFT));
+
+        // Retrigger and echo both default to 3 ticks
+        delay_target_fp[i] = one_tick_fp * (i == 0 ? 3 : i);
+
+        // Scale: (base * ticks_per_row_fp) / 1536, in engine ticks, at least one
+        uint16_t t = (uint16_t)(((uint32_t)(i == 0 ? 1 : i) * tpr) / 1536);
+        cut_tick_lut[i] = t ? t : 1;
+
+        t = (uint16_t)(((uint32_t)base_frames * tpr) / 1536);
+        gen_tick_lut[i] = t ? t : 1;
+
+        lfo_step_lut[i] = lfo_phase_step(i);
+    }
+}
+
 // Scale intervals (semitones from root)
 const uint8_t scale_intervals[8][16] = {
     {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15}, // 0: Chromatic
@@ -38,153 +85,215 @@ const uint8_t scale_intervals[8][16] = {
     {0,7,12,19,24,31,36,43,48,55,60,67,72,79}   // 7: 5ths & Octaves
 };
 
-// Add this to effects.c
-int16_t get_arp_offset(uint8_t style, uint8_t depth, uint8_t index) {
-    switch (style) {
-        case 0: return (index % 2 == 1) ? depth : 0; // UP
-        case 1: return (index % 2 == 0) ? depth : 0; // DOWN
-        case 2: // MAJOR (4-note: root, 3rd, 5th, octave)
-            if (index % 4 == 1) return 4;
-            if (index % 4 == 2) return 7;
-            if (index % 4 == 3) return 12;
-            return 0;
-        case 3: // MINOR (4-note: root, minor 3rd, 5th, octave)
-            if (index % 4 == 1) return 3;
-            if (index % 4 == 2) return 7;
-            if (index % 4 == 3) return 12;
-            return 0;
-        case 4: // MAJ7 (root, 3rd, 5th, maj7th)
-            if (index % 4 == 1) return 4;
-            if (index % 4 == 2) return 7;
-            if (index % 4 == 3) return 11;
-            return 0;
-        case 5: // MIN7 (root, minor 3rd, 5th, minor 7th)
-            if (index % 4 == 1) return 3;
-            if (index % 4 == 2) return 7;
-            if (index % 4 == 3) return 10;
-            return 0;
-        case 6: // SUS4 (root, 4th, 5th, octave)
-            if (index % 4 == 1) return 5;
-            if (index % 4 == 2) return 7;
-            if (index % 4 == 3) return 12;
-            return 0;
-        case 7: // SUS2 (root, 2nd, 5th, octave)
-            if (index % 4 == 1) return 2;
-            if (index % 4 == 2) return 7;
-            if (index % 4 == 3) return 12;
-            return 0;
-        case 8: // DIM (root, minor 3rd, dim 5th, dim 7th)
-            if (index % 4 == 1) return 3;
-            if (index % 4 == 2) return 6;
-            if (index % 4 == 3) return 9;
-            return 0;
-        case 9: // AUG (root, maj 3rd, aug 5th, octave)
-            if (index % 4 == 1) return 4;
-            if (index % 4 == 2) return 8;
-            if (index % 4 == 3) return 12;
-            return 0;
-        case 10: // POWER (root, 5th, octave, octave)
-            if (index % 4 == 1) return 7;
-            if (index % 4 == 2) return 12;
-            if (index % 4 == 3) return 12;
-            return 0;
-        case 11: // UPDOWN (root, up, up, root) - bounce pattern
-            if (index % 4 == 1) return depth;
-            if (index % 4 == 2) return depth;
-            if (index % 4 == 3) return 0;
-            return 0;
-        case 12: // GUITAR MAJOR STRUM (6-note cycle)
-            // Emulates an open-voiced G Major: G2, B2, D3, G3, B3, G4
-            {
-                uint8_t s = index % 6;
-                if (s == 1) return 4;  // Major 3rd
-                if (s == 2) return 7;  // 5th
-                if (s == 3) return 12; // Octave
-                if (s == 4) return 16; // Octave + 3rd
-                if (s == 5) return 19; // Octave + 5th (or 24 for high Root)
-                return 0;
-            }
+// Arp styles as step tables: semitones from the root, ARP_DEPTH for the
+// effect's D nibble. A channel walks its table with a cursor.
+#define D ARP_DEPTH
+static const uint8_t arp_steps[16][6] = {
+    {0, D},                  // 0: UP
+    {D, 0},                  // 1: DOWN
+    {0, 4, 7, 12},           // 2: MAJOR (root, 3rd, 5th, octave)
+    {0, 3, 7, 12},           // 3: MINOR (root, minor 3rd, 5th, octave)
+    {0, 4, 7, 11},           // 4: MAJ7 (root, 3rd, 5th, maj7th)
+    {0, 3, 7, 10},           // 5: MIN7 (root, minor 3rd, 5th, minor 7th)
+    {0, 5, 7, 12},           // 6: SUS4 (root, 4th, 5th, octave)
+    {0, 2, 7, 12},           // 7: SUS2 (root, 2nd, 5th, octave)
+    {0, 3, 6, 9},            // 8: DIM (root, minor 3rd, dim 5th, dim 7th)
+    {0, 4, 8, 12},           // 9: AUG (root, maj 3rd, aug 5th, octave)
+    {0, 7, 12, 12},          // A: POWER (root, 5th, octave, octave)
+    {0, D, D, 0},            // B: UPDOWN - bounce pattern
+    {0, 4, 7, 12, 16, 19},   // C: GUITAR MAJOR STRUM, open G: G2 B2 D3 G3 B3 G4
+    {0, 3, 7, 12, 15, 19},   // D: GUITAR MINOR STRUM, open Gm: G2 Bb2 D3 G3 Bb3 G4
+    {0, 0, 4, 7, 11, 14},    // E: GUITAR MAJ9: root, root, 3rd, 5th, 7th, 9th
+    {0, 0, D, D}             // F: DOUBLE - repeats each note
+};
+#undef D
 
-        case 13: // GUITAR MINOR STRUM (6-note cycle)
-            // Emulates an open-voiced G Minor: G2, Bb2, D3, G3, Bb3, G4
-            {
-                uint8_t s = index % 6;
-                if (s == 1) return 3;  // Minor 3rd
-                if (s == 2) return 7;  // 5th
-                if (s == 3) return 12; // Octave
-                if (s == 4) return 15; // Octave + Minor 3rd
-                if (s == 5) return 19; // Octave + 5th
-                return 0;
-            }
-        case 14: // GUITAR Major 9th (6-note cycle)
-            // Emulates an open-voiced Major 9th: Root, Root, 3rd, 5th, 7th, 9th
-            {
-                uint8_t s = index % 6;
-                if (s == 1) return 0;  // Minor 3rd
-                if (s == 2) return 4;  // 5th
-                if (s == 3) return 7; // Octave
-                if (s == 4) return 11; // Octave + Minor 3rd
-                if (s == 5) return 14; // Octave + 5th
-                return 0;
-            }
-        case 15: // DOUBLE (depth value unused, repeats each note)
-            return (index % 4 < 2) ? 0 : depth;
+static const uint8_t arp_len[16] = {
+    2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 6, 6, 6, 4
+};
+
+// Song-defined tables, for command B. Loaded and saved with the song.
+uint8_t song_arp_len[SONG_ARP_TABLES];
+uint8_t song_arp_steps[SONG_ARP_TABLES][ARP_MAX_STEPS];
+
+uint16_t song_gen_seed = GEN_DEFAULT_SEED;
+
+// Offset of the step under the channel's cursor
+uint8_t arp_offset(uint8_t ch) {
+    uint8_t step = ch_arp.steps[ch][ch_arp.step_index[ch]];
+    return (step == ARP_DEPTH) ? ch_arp.depth[ch] : step;
+}
+
+// ============================================================================
+// PITCH STAGE
+// ============================================================================
+
+// New note, keyed on when the frame resolves. The caller keys the old one
+// off first if it wants the envelope restarted.
+void pitch_strike(uint8_t ch, uint8_t note, int8_t detune) {
+    ch_pitch.note[ch] = note;
+    ch_pitch.detune[ch] = detune;
+    pitch_dirty |= (1u << ch);
+    pitch_key_on |= (1u << ch);
+    pitch_rekey &= ~(1u << ch);
+}
+
+// New note without a retrigger
+void pitch_glide(uint8_t ch, uint8_t note) {
+    ch_pitch.note[ch] = note;
+    pitch_dirty |= (1u << ch);
+    pitch_rekey &= ~(1u << ch);
+}
+
+void pitch_modulate(uint8_t ch, int16_t fine) {
+    FX_SET16(ch_pitch.fine, ch, FX_GET16(ch_pitch.fine, ch) + (uint16_t)fine);
+    pitch_dirty |= (1u << ch);
+    pitch_rekey &= ~(1u << ch);
+}
+
+// Block and F-number the chip has for a channel
+static uint16_t pitch_on_chip(uint8_t ch) {
+    return ((shadow_b0[ch] & 0x1F) << 8) | opl_hardware_shadow[0xA0 + ch];
+}
+
+// Key off now and strike again. A repeat of the note the chip already
+// sounds (retrigger, echo, same-note arp or generator step) only has its
+// key bit set by the resolve, unless something moves the pitch meanwhile.
+void pitch_restrike(uint8_t ch, uint8_t note) {
+    uint16_t bit = 1u << ch;
+    OPL_NoteOff(ch);
+    uint16_t exact = FX_GET16(ch_pitch.exact, ch);
+    if (note == ch_pitch.note[ch] && ch_pitch.detune[ch] == 0 &&
+        exact != PITCH_NOT_EXACT &&
+        exact == pitch_on_chip(ch) && !(pitch_dirty & bit)) {
+        pitch_dirty |= bit;
+        pitch_key_on |= bit;
+        pitch_rekey |= bit;
+        return;
     }
-    return 0;
+    pitch_strike(ch, note, 0);
 }
 
-void process_arp_logic(uint8_t ch) {
-    if (!ch_arp[ch].active) return;
+// Key off now, and drop a strike still waiting for the resolve
+void pitch_key_off(uint8_t ch) {
+    OPL_NoteOff(ch);
+    pitch_key_on &= ~(1u << ch);
+    pitch_rekey &= ~(1u << ch);
+}
+
+void pitch_resolve(void) {
+    uint16_t m = pitch_dirty;
+    for (uint8_t ch = 0; m; ch++, m >>= 1) {
+        if (!(m & 1)) continue;
+
+        if (pitch_rekey & (1u << ch)) {
+            OPL_KeyOn(ch);
+            continue;
+        }
+
+        int16_t fine = (int16_t)FX_GET16(ch_pitch.fine, ch) + ch_pitch.detune[ch];
+        ch_pitch.fine_lo[ch] = 0;
+        ch_pitch.fine_hi[ch] = 0;
 
+        bool key = (pitch_key_on & (1u << ch)) || (shadow_b0[ch] & 0x20);
+        OPL_SetFrequency(ch, ch_pitch.note[ch], fine, key);
+
+        // Remember the registers when they hold the note itself
+        FX_SET16(ch_pitch.exact, ch, fine ? PITCH_NOT_EXACT : pitch_on_chip(ch));
+    }
+    pitch_rekey = 0;
+    pitch_dirty = 0;
+    pitch_key_on = 0;
+}
+
+// ============================================================================
+// VOLUME STAGE
+// ============================================================================
+
+// Always marks the channel: a patch change in the same frame has written
+// the patch's own level over the last one
+void volume_set(uint8_t ch, uint8_t vol) {
+    ch_volume.level[ch] = vol;
+    volume_dirty |= (1u << ch);
+}
+
+void volume_modulate(uint8_t ch, int8_t offset) {
+    ch_volume.mod[ch] += offset;
+    volume_dirty |= (1u << ch);
+}
+
+void volume_resolve(void) {
+    uint16_t m = volume_dirty;
+    for (uint8_t ch = 0; m; ch++, m >>= 1) {
+        if (!(m & 1)) continue;
+
+        int16_t v = (int16_t)ch_volume.level[ch] + ch_volume.mod[ch];
+        ch_volume.mod[ch] = 0;
+        if (v < 0)  v = 0;
+        if (v > 63) v = 63;
+
+        // OPL_Write drops it if the chip has it already
+        OPL_SetVolume(ch, (uint8_t)v << 1);
+        ch_peaks[ch] = (uint8_t)v;
+    }
+    volume_dirty = 0;
+}
+
+void process_arp_logic(uint8_t ch) {
     // --- FIX 1: THE HICCUP ---
     // If the sequencer just struck a note, we consume the flag and return.
     // This prevents the Arp from re-striking on the same frame as the row note.
-    if (ch_arp[ch].just_triggered) {
-        ch_arp[ch].just_triggered = false;
+    if (ch_arp.just_triggered[ch]) {
+        ch_arp.just_triggered[ch] = false;
         return;
     }
 
     // --- FIX 2: THE SYNC DRIFT ---
-    // Increment timer by one fixed-point "frame" (256)
-    ch_arp[ch].phase_timer_fp += 256;
+    // Increment timer by one engine tick (256 = one frame)
+    uint16_t t = FX_GET16(ch_arp.timer, ch) + ENGINE_TICK_FP;
 
     // Check against the tempo-scaled target
-    if (ch_arp[ch].phase_timer_fp < ch_arp[ch].target_ticks_fp) return;
+    if (t < FX_GET16(ch_arp.target, ch)) {
+        FX_SET16(ch_arp.timer, ch, t);
+        return;
+    }
 
     // Reset and advance step
-    ch_arp[ch].phase_timer_fp = 0;
-    ch_arp[ch].step_index++; 
+    FX_SET16(ch_arp.timer, ch, 0);
+    uint8_t i = ch_arp.step_index[ch] + 1;
+    if (i >= ch_arp.len[ch]) i = 0;
+    ch_arp.step_index[ch] = i;
 
-    int16_t offset = get_arp_offset(ch_arp[ch].style, ch_arp[ch].depth, ch_arp[ch].step_index);
+    uint8_t offset = arp_offset(ch);
+
+    // Legato: just the new pitch, the envelope carries on
+    if (ch_arp.legato[ch]) {
+        pitch_glide(ch, ch_arp.base_note[ch] + offset);
+        return;
+    }
 
     // Retrigger
-    OPL_NoteOff(ch);
-    OPL_SetPatch(ch, &gm_bank[ch_arp[ch].inst]);
+    pitch_restrike(ch, ch_arp.base_note[ch] + offset);
+    OPL_SetPatch(ch, &gm_bank[ch_arp.inst[ch]]);
     
-    // RETAIN: Your MIDI vol << 1 mapping
-    uint8_t vol = ch_volslide[ch].active ? ch_volslide[ch].current_vol : ch_arp[ch].vol;
-    OPL_SetVolume(ch, vol << 1); 
-    
-    OPL_NoteOn(ch, ch_arp[ch].base_note + offset);
-    ch_peaks[ch] = vol; 
+    // Under a volume slide, keep to where the slide has got
+    uint8_t vol = (ch_fx[ch] & FX_VOLSLIDE) ? ch_volume.level[ch] : ch_arp.vol[ch];
+    volume_set(ch, vol);
 }
 
 void process_portamento_logic(uint8_t ch) {
-    if (!ch_porta[ch].active) return;
-
     // --- TICK 0 GUARD ---
     // Let the sequencer handle the initial note strike on Tick 0.
-    // Check if tick_counter_fp is less than 1.0 (TICK_SCALE = 256)
-    if (seq.tick_counter_fp < TICK_SCALE) return;
+    if (fx_row_start & (1u << ch)) return;
 
-    ch_porta[ch].tick_counter++;
+    ch_porta.tick_counter[ch]++;
 
     // Wait for speed delay (D)
-    if (ch_porta[ch].tick_counter < ch_porta[ch].speed) return;
-    ch_porta[ch].tick_counter = 0;
+    if (ch_porta.tick_counter[ch] < ch_porta.speed[ch]) return;
+    ch_porta.tick_counter[ch] = 0;
 
-    uint8_t current = ch_porta[ch].current_note;
-    uint8_t target = ch_porta[ch].target_note;
+    uint8_t current = ch_porta.current_note[ch];
+    uint8_t target = ch_porta.target_note[ch];
 
     if (current < target) {
         current++; // Slide Up
@@ -192,36 +301,33 @@ void process_portamento_logic(uint8_t ch) {
         current--; // Slide Down
     } else {
         // Target reached: stop the effect logic but keep the note ringing
-        ch_porta[ch].active = false;
+        ch_fx[ch] &= ~FX_PORTA;
         return;
     }
 
     // Update the state
-    ch_porta[ch].current_note = current;
+    ch_porta.current_note[ch] = current;
 
     // --- THE FIX: SMOOTH PITCH UPDATE ---
-    // Use OPL_SetPitch (like Vibrato) to change frequency 
-    // without triggering a new 'attack' or 'beep'.
-    OPL_SetPitch(ch, current);
+    // Glide to the new note without triggering a new 'attack' or 'beep'.
+    pitch_glide(ch, current);
     
     // Keep the meters alive
-    ch_peaks[ch] = ch_porta[ch].vol;
+    ch_peaks[ch] = ch_porta.vol[ch];
 }
 
 void process_volume_slide_logic(uint8_t ch) {
-    if (!ch_volslide[ch].active) return;
-
-    uint16_t v = ch_volslide[ch].vol_accum;
-    uint16_t step = ch_volslide[ch].speed_fp;
-    uint16_t target_fp = (uint16_t)ch_volslide[ch].target_vol << 8;
+    uint16_t v = FX_GET16(ch_volslide.vol_accum, ch);
+    uint16_t step = FX_GET16(ch_volslide.speed_fp, ch);
+    uint16_t target_fp = (uint16_t)ch_volslide.target_vol[ch] << 8;
     bool reached = false;
 
-    switch (ch_volslide[ch].mode) {
+    switch (ch_volslide.mode[ch]) {
         case 0: // SLIDE UP
             v += step;
             // Strict clamp at 63.0 (0x3F00) to prevent wrapping to 64
             if (v >= 0x3F00) { v = 0x3F00; reached = true; }
-            if (v >= target_fp && ch_volslide[ch].target_vol != 0) { v = target_fp; reached = true; }
+            if (v >= target_fp && ch_volslide.target_vol[ch] != 0) { v = target_fp; reached = true; }
             break;
 
         case 1: // SLIDE DOWN
@@ -248,181 +354,518 @@ void process_volume_slide_logic(uint8_t ch) {
             break;
     }
 
-    ch_volslide[ch].vol_accum = v;
+    FX_SET16(ch_volslide.vol_accum, ch, v);
     
     // Convert 8.8 Fixed Point to 0-63 Integer
     uint8_t final_vol = (uint8_t)(v >> 8);
 
     // --- AUDIO UPDATE ---
-    // We pass (0-63 << 1) to your routine to satisfy the 0-127 MIDI requirement
-    OPL_SetVolume(ch, final_vol << 1);
-    
-    // Update visual meters (0-63 scale)
-    ch_peaks[ch] = final_vol;
+    // The slide sets the channel level; tremolo may still ride on it
+    volume_set(ch, final_vol);
 
     if (reached) {
-        ch_volslide[ch].active = false;
+        ch_fx[ch] &= ~FX_VOLSLIDE;
     }
 }
 
 void process_vibrato_logic(uint8_t ch) {
-    if (!ch_vibrato[ch].active) return;
-    if (seq.tick_counter_fp == 0) return;
-
-    uint16_t inc = (uint16_t)ch_vibrato[ch].rate * lfo_tempo_scaler;
-    ch_vibrato[ch].phase += (uint8_t)(inc >> 7);
+    if (fx_row_start & (1u << ch)) return;
 
-    int16_t lfo_val = 0;
-    uint8_t p = ch_vibrato[ch].phase;
-    uint8_t d = ch_vibrato[ch].depth;
-
-    if (ch_vibrato[ch].waveform == 0)      lfo_val = (p < 128) ? (p / 8 - 8) : (8 - (p - 128) / 8);
-    else if (ch_vibrato[ch].waveform == 1) lfo_val = (p < 128) ? (p / 8 - 8) : (24 - p / 8 - 8);
-    else                                   lfo_val = (p < 128) ? 8 : -8;
+    uint16_t phase = FX_GET16(ch_vibrato.phase, ch) + lfo_step_lut[ch_vibrato.rate[ch]];
+    FX_SET16(ch_vibrato.phase, ch, phase);
+    int8_t w = lfo_wave[ch_vibrato.waveform[ch]][phase >> 8];
 
     // --- THE BOOST ---
-    // Dividing by 8 instead of 16.
+    // Wave * depth / 32, in 1/32 semitones.
     // Result: If D=8, pitch swings +/- 1 semitone. If D=F, swings nearly +/- 2.
-    int8_t fine_offset = (int8_t)((lfo_val * (int16_t)d) / 8);
-
-    OPL_SetPitch_Fine(ch, ch_vibrato[ch].base_note, fine_offset);
+    // On top of whatever note the channel is on, slides included.
+    pitch_modulate(ch, lfo_scale(w, ch_vibrato.depth[ch]) >> 5);
 }
 
 void process_notecut_logic(uint8_t ch) {
-    if (!ch_notecut[ch].active) return;
-    
-    ch_notecut[ch].tick_counter++;
-    
-    if (ch_notecut[ch].tick_counter >= ch_notecut[ch].cut_tick) {
-        OPL_NoteOff(ch);
+    uint16_t t = FX_GET16(ch_notecut.tick_counter, ch) + 1;
+    FX_SET16(ch_notecut.tick_counter, ch, t);
+
+    if (t >= FX_GET16(ch_notecut.cut_tick, ch)) {
+        pitch_key_off(ch);
         ch_peaks[ch] = 0;
-        ch_notecut[ch].active = false;
+        ch_fx[ch] &= ~FX_NOTECUT;
     }
 }
 
 void process_notedelay_logic(uint8_t ch) {
-    if (!ch_notedelay[ch].active) return;
-
     // Tick 0 Guard: The sequencer triggered the first note, start counting now
-    if (seq.tick_counter_fp == 0) return;
+    if (fx_row_start & (1u << ch)) return;
 
-    // 1. Accumulate one VSync frame of time
-    ch_notedelay[ch].timer_fp += 256;
+    // 1. Accumulate one engine tick of time (256 = one VSync frame)
+    uint16_t t = FX_GET16(ch_notedelay.timer, ch) + ENGINE_TICK_FP;
+    FX_SET16(ch_notedelay.timer, ch, t);
 
     // 2. Threshold check
-    if (ch_notedelay[ch].timer_fp >= ch_notedelay[ch].target_fp) {
+    if (t >= FX_GET16(ch_notedelay.target, ch)) {
         
         // --- LOGARITHMIC DECAY ---
         uint8_t decay_step = 8; // Drop by 8 units (~6dB)
-        if (ch_notedelay[ch].vol > decay_step) {
-            ch_notedelay[ch].vol -= decay_step;
+        if (ch_notedelay.vol[ch] > decay_step) {
+            ch_notedelay.vol[ch] -= decay_step;
 
             // Trigger the echo
-            OPL_NoteOff(ch);
-            OPL_SetPatch(ch, &gm_bank[ch_notedelay[ch].inst]);
-            OPL_SetVolume(ch, ch_notedelay[ch].vol << 1); // Maintain MIDI mapping
-            OPL_NoteOn(ch, ch_notedelay[ch].note);
-            
-            ch_peaks[ch] = ch_notedelay[ch].vol;
+            pitch_restrike(ch, ch_notedelay.note[ch]);
+            OPL_SetPatch(ch, &gm_bank[ch_notedelay.inst[ch]]);
+            volume_set(ch, ch_notedelay.vol[ch]);
             
             // 3. Reset timer to loop the echo
-            ch_notedelay[ch].timer_fp = 0; 
+            FX_SET16(ch_notedelay.timer, ch, 0);
         } else {
             // Faded to silence
-            ch_notedelay[ch].vol = 0;
-            ch_notedelay[ch].active = false;
+            ch_notedelay.vol[ch] = 0;
+            ch_fx[ch] &= ~FX_NOTEDELAY;
         }
     }
 }
 
 void process_retrigger_logic(uint8_t ch) {
-    if (!ch_retrigger[ch].active) return;
-
     // Tick 0 Guard: The sequencer just struck the note, 
     // so we skip this frame and start counting.
-    if (ch_retrigger[ch].just_triggered) {
-        ch_retrigger[ch].just_triggered = false;
+    if (ch_retrigger.just_triggered[ch]) {
+        ch_retrigger.just_triggered[ch] = false;
         return;
     }
 
     // 1. Accumulate time (256 = 1 VSync frame)
-    ch_retrigger[ch].timer_fp += 256;
+    uint16_t t = FX_GET16(ch_retrigger.timer, ch) + ENGINE_TICK_FP;
 
     // 2. Check if we reached the tempo-scaled target
-    if (ch_retrigger[ch].timer_fp >= ch_retrigger[ch].target_fp) {
-        ch_retrigger[ch].timer_fp = 0;
+    if (t < FX_GET16(ch_retrigger.target, ch)) {
+        FX_SET16(ch_retrigger.timer, ch, t);
+    } else {
+        FX_SET16(ch_retrigger.timer, ch, 0);
         
         // --- THE ACTION ---
-        OPL_NoteOff(ch);
-        OPL_SetPatch(ch, &gm_bank[ch_retrigger[ch].inst]);
-        OPL_SetVolume(ch, ch_retrigger[ch].vol << 1); 
-        OPL_NoteOn(ch, ch_retrigger[ch].note);
-        
-        ch_peaks[ch] = ch_retrigger[ch].vol;
+        pitch_restrike(ch, ch_retrigger.note[ch]);
+        OPL_SetPatch(ch, &gm_bank[ch_retrigger.inst[ch]]);
+        volume_set(ch, ch_retrigger.vol[ch]);
     }
 }
 
 void process_tremolo_logic(uint8_t ch) {
-    if (!ch_tremolo[ch].active) return;
-    if (seq.tick_counter_fp == 0) return;
+    if (fx_row_start & (1u << ch)) return;
 
-    uint16_t inc = (uint16_t)ch_tremolo[ch].rate * lfo_tempo_scaler;
-    ch_tremolo[ch].phase += (uint8_t)(inc >> 7);
-
-    int16_t lfo_val = 0;
-    uint8_t p = ch_tremolo[ch].phase;
-    if (ch_tremolo[ch].waveform == 0)      lfo_val = (p < 128) ? (p / 8 - 8) : (8 - (p - 128) / 8);
-    else if (ch_tremolo[ch].waveform == 1) lfo_val = (p < 128) ? (p / 8 - 8) : (24 - p / 8 - 8);
-    else                                   lfo_val = (p < 128) ? 8 : -8;
+    uint16_t phase = FX_GET16(ch_tremolo.phase, ch) + lfo_step_lut[ch_tremolo.rate[ch]];
+    FX_SET16(ch_tremolo.phase, ch, phase);
+    int8_t w = lfo_wave[ch_tremolo.waveform[ch]][phase >> 8];
 
     // --- THE BOOST ---
-    // We multiply by Depth and divide by 4.
-    // Now D=4 creates a pulsing of +/- 8 volume units (out of 63). 
+    // Wave * depth / 64, in volume units (out of 63).
+    // Now D=4 creates a pulsing of +/- 8 volume units.
     // D=F will create a very heavy pulse of +/- 30 units.
-    int16_t vol_offset = (lfo_val * (int16_t)ch_tremolo[ch].depth) / 4;
-    int16_t new_vol = (int16_t)ch_tremolo[ch].base_vol + vol_offset;
-
-    if (new_vol < 0)  new_vol = 0;
-    if (new_vol > 63) new_vol = 63;
+    // Around the channel level, so it pulses over a volume slide too.
+    volume_modulate(ch, (int8_t)(lfo_scale(w, ch_tremolo.depth[ch]) >> 6));
+}
 
-    OPL_SetVolume(ch, (uint8_t)new_vol << 1);
-    ch_peaks[ch] = (uint8_t)new_vol;
+// Give each channel its own sequence from the song's seed
+void gen_seed(void) {
+    uint16_t x = song_gen_seed;
+    for (uint8_t ch = 0; ch < 9; ch++) {
+        FX_SET16(ch_generator.rng, ch, x ? x : GEN_DEFAULT_SEED);
+        x += 0x9E37;
+    }
 }
 
-void process_finepitch_logic(uint8_t ch) {
-    if (!ch_finepitch[ch].active) return;
-    
-    // Fine pitch is applied once on trigger, not per-tick
-    // The detune is handled by OPL frequency offset
-    // This is a no-op per-tick processor (effect is instant)
+// 16-bit xorshift (7, 9, 8): shifts of 7 and 9 are one-bit shifts across
+// a byte move, cheap on the 6502. Full period, 65535 values.
+static uint8_t gen_next(uint8_t ch) {
+    uint16_t x = FX_GET16(ch_generator.rng, ch);
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    FX_SET16(ch_generator.rng, ch, x);
+    return (uint8_t)x;
 }
 
 void process_gen_logic(uint8_t ch) {
-    if (!ch_generator[ch].active) return;
-
     // --- JUST TRIGGERED GUARD ---
     // Skip processing this frame to avoid double-hit, matching ch_arp timing
-    if (ch_generator[ch].just_triggered) {
-        ch_generator[ch].just_triggered = false;
+    if (ch_generator.just_triggered[ch]) {
+        ch_generator.just_triggered[ch] = false;
         return;
     }
 
-    ch_generator[ch].timer++;
-    if (ch_generator[ch].timer < ch_generator[ch].target_ticks) return;
-    ch_generator[ch].timer = 0;
+    uint16_t t = FX_GET16(ch_generator.timer, ch) + 1;
+    if (t < FX_GET16(ch_generator.target_ticks, ch)) {
+        FX_SET16(ch_generator.timer, ch, t);
+        return;
+    }
+    FX_SET16(ch_generator.timer, ch, 0);
 
     // --- GENERATIVE STEP ---
     // 1. Pick a random index within the Depth (D) range
-    // Using RIA.vsync as a seed for the 6502
-    uint8_t random_step = RIA.vsync % (ch_generator[ch].range + 1);
+    uint8_t random_step = gen_next(ch) % (ch_generator.range[ch] + 1);
     
     // 2. Look up the semitone offset for the current scale
-    uint8_t offset = scale_intervals[ch_generator[ch].scale & 0x07][random_step];
+    uint8_t offset = scale_intervals[ch_generator.scale[ch] & 0x07][random_step];
 
     // 3. RETRIGGER
+    pitch_restrike(ch, ch_generator.base_note[ch] + offset);
+    OPL_SetPatch(ch, &gm_bank[ch_generator.inst[ch]]);
+    volume_set(ch, ch_generator.vol[ch]);
+}
+
+// Per-frame engines in ch_fx bit order. Fine pitch has no frame work.
+typedef void (*EffectTickFn)(uint8_t ch);
+static const EffectTickFn effect_tick_table[FX_COUNT] = {
+    process_arp_logic,           // FX_ARP
+    process_portamento_logic,    // FX_PORTA
+    process_volume_slide_logic,  // FX_VOLSLIDE
+    process_vibrato_logic,       // FX_VIBRATO
+    process_notecut_logic,       // FX_NOTECUT
+    process_notedelay_logic,     // FX_NOTEDELAY
+    process_retrigger_logic,     // FX_RETRIGGER
+    process_tremolo_logic,       // FX_TREMOLO
+    0,                           // FX_FINEPITCH
+    process_gen_logic            // FX_GEN
+};
+
+void effects_run_channel(uint8_t ch) {
+    uint16_t fx = ch_fx[ch] & FX_PER_FRAME;
+    for (uint8_t i = 0; fx; i++, fx >>= 1) {
+        if (fx & 1) effect_tick_table[i](ch);
+    }
+}
+
+// ============================================================================
+// EFFECT COMMAND PARSING
+// ============================================================================
+// One parse entry per command nibble, called by the sequencer when a cell's
+// effect differs from last_effect[ch]. Each returns true if it already struck
+// the row's note itself, so the sequencer must not trigger it again.
+
+// Note to use when a command appears on a row without a note of its own
+#define CELL_HAS_NOTE(c) ((c)->note != 0 && (c)->note != 255)
+
+// Stopping any other engine is just clearing its ch_fx bit
+void tremolo_reset(uint8_t ch) {
+    if (ch_fx[ch] & FX_TREMOLO) {
+        ch_fx[ch] &= ~FX_TREMOLO;
+        volume_modulate(ch, 0); // Back to the unmodulated level
+    }
+}
+
+// Kill every engine on the channel (F000, or a new note with no command).
+// Only tremolo has anything to undo. Vibrato leaves the pitch alone: a
+// new note trigger will follow and set its own.
+void effects_reset_channel(uint8_t ch) {
+    tremolo_reset(ch);
+    ch_fx[ch] = 0;
+}
+
+static void arp_start(uint8_t ch, uint16_t eff, const uint8_t *steps, uint8_t len,
+                      bool legato) {
+    ch_fx[ch] |= FX_ARP;
+    ch_arp.steps[ch] = steps;
+    ch_arp.len[ch]   = len;
+    ch_arp.legato[ch] = legato;
+    ch_arp.depth[ch] = (eff >> 4) & 0x0F;
+    ch_arp.speed_idx[ch] = (eff & 0x0F);
+
+    // --- SCALE ARP TO TEMPO ---
+    FX_SET16(ch_arp.target, ch, arp_target_fp[ch_arp.speed_idx[ch]]);
+
+    FX_SET16(ch_arp.timer, ch, 0);
+    ch_arp.step_index[ch] = 0;
+    ch_arp.just_triggered[ch] = true; // Prevent double-trigger on same row
+}
+
+// Arpeggio: 1SDT
+static bool arp_parse(uint8_t ch, const PatternCell *cell) {
+    uint8_t style = (cell->effect >> 8) & 0x0F;
+    arp_start(ch, cell->effect, arp_steps[style], arp_len[style], false);
+    return false;
+}
+
+// Legato Arpeggio: CSDT, like 1SDT but steps glide instead of retriggering
+static bool legato_arp_parse(uint8_t ch, const PatternCell *cell) {
+    uint8_t style = (cell->effect >> 8) & 0x0F;
+    arp_start(ch, cell->effect, arp_steps[style], arp_len[style], true);
+    return false;
+}
+
+// Song Arpeggio: BNDT, like 1SDT with the song's table N. N 8-F plays
+// table N-8 legato.
+static bool song_arp_parse(uint8_t ch, const PatternCell *cell) {
+    uint8_t n = (cell->effect >> 8) & 0x0F;
+    bool legato = n >= SONG_ARP_TABLES;
+    if (legato) n -= SONG_ARP_TABLES;
+    if (!song_arp_len[n]) return false; // Not defined
+    arp_start(ch, cell->effect, song_arp_steps[n], song_arp_len[n], legato);
+    return false;
+}
+
+// Portamento: 2SDT
+static bool porta_parse(uint8_t ch, const PatternCell *cell) {
+    uint16_t eff = cell->effect;
+    uint8_t mode = (eff >> 8) & 0x0F;
+    uint8_t speed = (eff >> 4) & 0x0F;
+    uint8_t t_val = (eff & 0x0F);
+
+    // Starting Note: If there's a new note on this row, start from it.
+    // Otherwise, start from whatever the channel was last playing.
+    uint8_t start_note = CELL_HAS_NOTE(cell) ? cell->note : ch_arp.base_note[ch];
+
+    ch_fx[ch] |= FX_PORTA;
+    ch_porta.current_note[ch] = start_note;
+    ch_porta.mode[ch] = mode;
+    // D is in frames, the counter runs on engine ticks
+    ch_porta.speed[ch] = ((speed == 0) ? 1 : speed) << ENGINE_TICK_SHIFT;
+    ch_porta.tick_counter[ch] = 0;
+    ch_porta.vol[ch] = (cell->note != 0) ? cell->vol : ch_arp.vol[ch];
+    ch_porta.inst[ch] = (cell->note != 0) ? cell->inst : ch_arp.inst[ch];
+
+    // Calculate Target
+    switch (mode) {
+        case 0: ch_porta.target_note[ch] = 127; break; // Continuous Up
+        case 1: ch_porta.target_note[ch] = 0;   break; // Continuous Down
+        case 2: // Up Relative
+            {
+                uint16_t t = (uint16_t)start_note + (t_val == 0 ? 12 : t_val);
+                ch_porta.target_note[ch] = (t > 127) ? 127 : (uint8_t)t;
+            }
+            break;
+        case 3: // Down Relative
+            {
+                int16_t t = (int16_t)start_note - (t_val == 0 ? 12 : t_val);
+                ch_porta.target_note[ch] = (t < 0) ? 0 : (uint8_t)t;
+            }
+            break;
+    }
+
+    // Kill Arp so they don't fight over the pitch
+    ch_fx[ch] &= ~FX_ARP;
+    return false;
+}
+
+// Volume Slide: 3SDT
+// S = Mode (0=Up, 1=Down, 2=To Target)
+// D = Speed (volume units per tick)
+// T = Target volume (0-F represents 0-63 scaled)
+static bool volslide_parse(uint8_t ch, const PatternCell *cell) {
+    uint16_t eff = cell->effect;
+    uint8_t s_nibble = (eff >> 8) & 0x0F; // Mode
+    uint8_t d_nibble = (eff >> 4) & 0x0F; // Speed (1-F)
+    uint8_t t_nibble = (eff & 0x0F);      // Target (0-F)
+
+    ch_fx[ch] |= FX_VOLSLIDE;
+    ch_volslide.mode[ch] = s_nibble;
+
+    // 1. Start from current row's volume (0-63)
+    FX_SET16(ch_volslide.vol_accum, ch, (uint16_t)cell->vol << 8);
+
+    // 2. Scale 0-F target to 0-63
+    ch_volslide.target_vol[ch] = (t_nibble * 63) / 15;
+
+    // 3. Set Speed: 84 is the "Magic Number" for ~32 rows at Speed 1
+    // (per frame, so split across the frame's engine ticks)
+    if (d_nibble == 0) d_nibble = 1;
+    FX_SET16(ch_volslide.speed_fp, ch, ((uint16_t)d_nibble * 84U) >> ENGINE_TICK_SHIFT);
+
+    // 4. Default targets for Mode 0 (Up) and 1 (Down) if T is 0
+    if (s_nibble == 0 && t_nibble == 0) ch_volslide.target_vol[ch] = 63;
+    if (s_nibble == 1 && t_nibble == 0) ch_volslide.target_vol[ch] = 0;
+    return false;
+}
+
+// Vibrato: 4RDT
+// R = Rate (ticks per phase step - lower = faster)
+// D = Depth (pitch deviation in semitones)
+// T = Waveform (0=sine, 1=triangle, 2=square)
+static bool vibrato_parse(uint8_t ch, const PatternCell *cell) {
+    uint16_t eff = cell->effect;
+
+    // Modulates whatever the channel plays, see process_vibrato_logic()
+    ch_fx[ch] |= FX_VIBRATO;
+    ch_vibrato.rate[ch] = (eff >> 8) & 0x0F;
+    if (ch_vibrato.rate[ch] == 0) ch_vibrato.rate[ch] = 4; // Default rate
+    ch_vibrato.depth[ch] = (eff >> 4) & 0x0F;
+    if (ch_vibrato.depth[ch] == 0) ch_vibrato.depth[ch] = 2; // Default depth
+    ch_vibrato.waveform[ch] = lfo_shape(eff & 0x0F);
+    FX_SET16(ch_vibrato.phase, ch, 0);
+
+    ch_fx[ch] &= ~FX_ARP; // Vibrato kills arpeggio
+    return false;
+}
+
+// Note Cut: 5__T
+// T = Ticks before cut (0-F maps to 0-15 ticks)
+static bool notecut_parse(uint8_t ch, const PatternCell *cell) {
+    FX_SET16(ch_notecut.cut_tick, ch, cut_tick_lut[cell->effect & 0x0F]);
+
+    ch_fx[ch] |= FX_NOTECUT;
+    FX_SET16(ch_notecut.tick_counter, ch, 0);
+    return false;
+}
+
+// Automatic Echo: 6VDT
+static bool notedelay_parse(uint8_t ch, const PatternCell *cell) {
+    uint16_t eff = cell->effect;
+    uint8_t echo_vol_nibble = (eff >> 8) & 0x0F;
+    uint8_t delay_nibble    = (eff >> 4) & 0x0F;
+    uint8_t transposition   = (eff & 0x0F);
+
+    uint8_t base = CELL_HAS_NOTE(cell) ? cell->note : ch_arp.base_note[ch];
+
+    ch_fx[ch] |= FX_NOTEDELAY;
+    FX_SET16(ch_notedelay.timer, ch, 0);
+
+    // --- THE TEMPO SCALE FIX ---
+    // Delay 0 defaults to half a row
+    FX_SET16(ch_notedelay.target, ch, delay_target_fp[delay_nibble]);
+
+    // Set note, inst, and starting volume
+    ch_notedelay.note[ch] = base + transposition;
+    if (ch_notedelay.note[ch] > 127) ch_notedelay.note[ch] = 127;
+    ch_notedelay.vol[ch] = (echo_vol_nibble * 63) / 15;
+    ch_notedelay.inst[ch] = (cell->note != 0) ? cell->inst : ch_arp.inst[ch];
+
+    // Note: We do NOT set skip_note_trigger.
+    // The note in cell->note will play normally on Tick 0.
+    return false;
+}
+
+// Retrigger: 7__T
+static bool retrigger_parse(uint8_t ch, const PatternCell *cell) {
+    uint8_t t_nibble = (cell->effect & 0x0F);
+    uint8_t speed = (t_nibble == 0) ? 3 : t_nibble; // Default
+
+    bool has_note = CELL_HAS_NOTE(cell);
+
+    ch_fx[ch] |= FX_RETRIGGER;
+    ch_retrigger.speed[ch] = speed;
+    ch_retrigger.note[ch] = has_note ? cell->note : ch_arp.base_note[ch];
+    ch_retrigger.inst[ch] = has_note ? cell->inst : ch_arp.inst[ch];
+    ch_retrigger.vol[ch]  = has_note ? cell->vol : ch_arp.vol[ch];
+
+    // --- THE FIX: SCALE TO TEMPO ---
+    // At 150 BPM, one musical tick = 256 (TICK_SCALE).
+    FX_SET16(ch_retrigger.target, ch, delay_target_fp[t_nibble]);
+
+    FX_SET16(ch_retrigger.timer, ch, 0);
+    ch_retrigger.just_triggered[ch] = true; // Sync with sequencer strike
+    return false;
+}
+
+// Tremolo: 8RDT
+static bool tremolo_parse(uint8_t ch, const PatternCell *cell) {
+    uint16_t eff = cell->effect;
+
+    // Sync base state
+    ch_fx[ch] |= FX_TREMOLO;
+    ch_tremolo.rate[ch] = (eff >> 8) & 0x0F;
+    ch_tremolo.depth[ch] = (eff >> 4) & 0x0F;
+    ch_tremolo.waveform[ch] = lfo_shape(eff & 0x0F);
+
+    // Oscillates around the channel level, see process_tremolo_logic()
+
+    // Optional: Reset phase on new note to make the pulse predictable
+    if (cell->note != 0) {
+        FX_SET16(ch_tremolo.phase, ch, 0);
+    }
+    return false;
+}
+
+// Fine Pitch: 9_DD (8-bit signed)
+// Interprets the lower 8 bits as a signed value (-128 to 127)
+// representing steps of 1/32 semitone.
+static bool finepitch_parse(uint8_t ch, const PatternCell *cell) {
+    int8_t detune = (int8_t)(cell->effect & 0xFF);
+
+    // Deciding the note to play:
+    bool has_note = CELL_HAS_NOTE(cell);
+    uint8_t note = has_note ? cell->note : ch_arp.base_note[ch];
+
+    ch_fx[ch] |= FX_FINEPITCH;
+    ch_finepitch.base_note[ch] = note;
+    ch_finepitch.detune[ch] = detune;
+    ch_finepitch.inst[ch] = has_note ? cell->inst : ch_arp.inst[ch];
+    ch_finepitch.vol[ch] = has_note ? cell->vol : ch_arp.vol[ch];
+
+    // Strike the detuned note now
     OPL_NoteOff(ch);
-    OPL_SetPatch(ch, &gm_bank[ch_generator[ch].inst]);
-    OPL_SetVolume(ch, ch_generator[ch].vol << 1); 
-    OPL_NoteOn(ch, ch_generator[ch].base_note + offset);
-    ch_peaks[ch] = ch_generator[ch].vol;
-}
\ No newline at end of file
+    OPL_SetPatch(ch, &gm_bank[ch_finepitch.inst[ch]]);
+    volume_set(ch, ch_finepitch.vol[ch]);
+
+    // The detune stays with the note, under any vibrato or slide
+    pitch_strike(ch, note, detune);
+
+    // Mark this as handled so the sequencer doesn't strike it again
+    return true;
+}
+
+// Random Generator: ASDT
+static bool gen_parse(uint8_t ch, const PatternCell *cell) {
+    uint16_t eff = cell->effect;
+
+    ch_fx[ch] |= FX_GEN;
+    ch_generator.scale[ch]  = (eff >> 8) & 0x0F;
+    ch_generator.range[ch]  = (eff >> 4) & 0x0F;
+
+    // Scale generator timing with tempo (same as arpeggio)
+    FX_SET16(ch_generator.target_ticks, ch, gen_tick_lut[eff & 0x0F]);
+
+    FX_SET16(ch_generator.timer, ch, 0);
+    ch_generator.just_triggered[ch] = true;
+
+    // --- CAPTURE CONTEXT ---
+    // If there is a note on this row, use it.
+    // Otherwise, fall back to the last known state for this channel.
+    if (CELL_HAS_NOTE(cell)) {
+        ch_generator.base_note[ch] = cell->note;
+        ch_generator.inst[ch] = cell->inst;
+        ch_generator.vol[ch]  = cell->vol;
+    } else {
+        // Fallback to Arp memory if no note on this row
+        ch_generator.base_note[ch] = ch_arp.base_note[ch];
+        ch_generator.inst[ch] = ch_arp.inst[ch];
+        ch_generator.vol[ch]  = ch_arp.vol[ch];
+    }
+    return false;
+}
+
+// Command 0: a new note with no command kills all running effects.
+// Empty rows should NOT reset vibrato pitch - let it oscillate freely.
+static bool none_parse(uint8_t ch, const PatternCell *cell) {
+    if (cell->note != 0) effects_reset_channel(ch);
+    return false;
+}
+
+// Command F: F000 is the explicit "Kill Effect"
+static bool kill_parse(uint8_t ch, const PatternCell *cell) {
+    if (cell->effect == 0xF000) effects_reset_channel(ch);
+    return false;
+}
+
+// Commands D-E are not assigned yet
+static bool unused_parse(uint8_t ch, const PatternCell *cell) {
+    (void)ch;
+    (void)cell;
+    return false;
+}
+
+// Indexed by the command nibble (bits 12-15 of the effect word)
+const EffectParseFn effect_parse_table[16] = {
+    none_parse,       // 0: None / kill on new note
+    arp_parse,        // 1: Arpeggio
+    porta_parse,      // 2: Portamento
+    volslide_parse,   // 3: Volume Slide
+    vibrato_parse,    // 4: Vibrato
+    notecut_parse,    // 5: Note Cut
+    notedelay_parse,  // 6: Echo
+    retrigger_parse,  // 7: Retrigger
+    tremolo_parse,    // 8: Tremolo
+    finepitch_parse,  // 9: Fine Pitch
+    gen_parse,        // A: Random Generator
+    song_arp_parse,   // B: Song Arpeggio
+    legato_arp_parse, // C: Legato Arpeggio
+    unused_parse,     // D
+    unused_parse,     // E
+    kill_parse        // F: Kill Effect
+};
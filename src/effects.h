@@ -1,125 +1,226 @@
 #ifndef EFFECTS_C
 #define EFFECTS_C
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "screen.h"
+
+// Effect state is kept as structs of per-channel arrays rather than arrays
+// of structs: ch_arp.step_index[ch] is a fixed address plus the channel,
+// which the 6502 reads with abs,X and no multiply. Every 16-bit field
+// (timers, 8.8 accumulators, phases, the generator state) is split the
+// same way into _lo and _hi byte arrays, since a uint16_t[9] would need
+// the index doubled first.
+#define FX_GET16(f, ch) ((uint16_t)((f##_hi)[ch] << 8 | (f##_lo)[ch]))
+#define FX_SET16(f, ch, v) \
+    do { uint16_t v_ = (v); (f##_lo)[ch] = (uint8_t)v_; (f##_hi)[ch] = (uint8_t)(v_ >> 8); } while (0)
+
 typedef struct {
-    uint8_t base_note;
-    uint8_t inst;
-    uint8_t vol;
-    uint8_t style;
-    uint8_t depth;
-    uint8_t speed_idx;   // The T nibble (0-F)
-    uint16_t target_ticks_fp; // Now 8.8 fixed point
-    uint16_t phase_timer_fp;  // Now 8.8 fixed point
-    uint8_t step_index;  
-    bool    active;
-    bool    just_triggered; // Prevents double-hit on same frame
+    uint8_t base_note[9];
+    uint8_t inst[9];
+    uint8_t vol[9];
+    const uint8_t *steps[9]; // Step table, builtin style or song table
+    uint8_t len[9];          // Steps in it
+    uint8_t depth[9];
+    uint8_t speed_idx[9]; // The T nibble (0-F)
+    uint8_t target_lo[9];    // Step length, 8.8 frames
+    uint8_t target_hi[9];
+    uint8_t timer_lo[9];     // Time into the step, 8.8 frames
+    uint8_t timer_hi[9];
+    uint8_t step_index[9];
+    bool    just_triggered[9]; // Prevents double-hit on same frame
+    bool    legato[9];         // Steps move the pitch without a retrigger
 } ArpState;
 
 typedef struct {
-    uint8_t current_note;
-    uint8_t target_note;
-    uint8_t inst;
-    uint8_t vol;
-    uint8_t mode;         // 0=Up, 1=Down, 2=To Target
-    uint8_t speed;        // Ticks between steps
-    uint8_t tick_counter;
-    bool    active;
+    uint8_t current_note[9];
+    uint8_t target_note[9];
+    uint8_t inst[9];
+    uint8_t vol[9];
+    uint8_t mode[9];      // 0=Up, 1=Down, 2=To Target
+    uint8_t speed[9];     // Ticks between steps
+    uint8_t tick_counter[9];
 } PortamentoState;
 
 // Volume Slide State with 8.8 Fixed Point Arithmetic
 typedef struct {
-    uint8_t current_vol;
-    uint8_t base_note;
-    uint8_t inst;
-    uint8_t speed;
-    uint8_t tick_counter;
-    uint16_t vol_accum;   // 8.8 Fixed Point (Integer part in high byte: 0-63)
-    uint16_t speed_fp;    // Fixed point increment per tick
-    uint8_t  target_vol;  // Target integer volume (0-63)
-    uint8_t  mode;        // 0:Up, 1:Down, 2:To Target
-    bool     active;
+    uint8_t base_note[9];
+    uint8_t inst[9];
+    uint8_t speed[9];
+    uint8_t tick_counter[9];
+    uint8_t  vol_accum_lo[9]; // 8.8 Fixed Point (Integer part in high byte: 0-63)
+    uint8_t  vol_accum_hi[9];
+    uint8_t  speed_fp_lo[9];  // Fixed point increment per tick
+    uint8_t  speed_fp_hi[9];
+    uint8_t  target_vol[9]; // Target integer volume (0-63)
+    uint8_t  mode[9];     // 0:Up, 1:Down, 2:To Target
 } VolumeSlideState;
 
 typedef struct {
-    uint8_t base_note;
-    uint8_t inst;
-    uint8_t vol;
-    uint8_t rate;         // Oscillation speed (ticks per cycle step)
-    uint8_t depth;        // Pitch deviation (semitones/fine)
-    uint8_t waveform;     // 0=sine, 1=triangle, 2=square
-    uint8_t phase;        // Current position in wave (0-255)
-    uint8_t tick_counter;
-    bool    active;
+    uint8_t rate[9];      // Oscillation speed (ticks per cycle step)
+    uint8_t depth[9];     // Pitch deviation (semitones/fine)
+    uint8_t waveform[9];  // LFO_*, see lfo.h
+    uint8_t phase_lo[9];  // Position in the wave, 8.8: the high byte
+    uint8_t phase_hi[9];  // is the wave table index
 } VibratoState;
 
 typedef struct {
-    uint8_t cut_tick;     // Tick count when to cut
-    uint8_t tick_counter;
-    bool    active;
+    uint8_t cut_tick_lo[9]; // Tick count when to cut
+    uint8_t cut_tick_hi[9];
+    uint8_t tick_counter_lo[9];
+    uint8_t tick_counter_hi[9];
 } NoteCutState;
 
 typedef struct {
-    uint16_t timer_fp;    // Accumulator (8.8)
-    uint16_t target_fp;   // Threshold (8.8)
-    uint8_t note;
-    uint8_t inst;
-    uint8_t vol;
-    bool    active;
+    uint8_t timer_lo[9];  // Accumulator (8.8)
+    uint8_t timer_hi[9];
+    uint8_t target_lo[9]; // Threshold (8.8)
+    uint8_t target_hi[9];
+    uint8_t note[9];
+    uint8_t inst[9];
+    uint8_t vol[9];
 } NoteDelayState;
 
 typedef struct {
-    uint16_t timer_fp;    // Accumulator (8.8)
-    uint16_t target_fp;   // Threshold (8.8)
-    uint8_t note;
-    uint8_t inst;
-    uint8_t vol;
-    uint8_t speed;        // T nibble
-    bool    active;
-    bool    just_triggered; // Prevent Tick 0 double-hit
+    uint8_t timer_lo[9];  // Accumulator (8.8)
+    uint8_t timer_hi[9];
+    uint8_t target_lo[9]; // Threshold (8.8)
+    uint8_t target_hi[9];
+    uint8_t note[9];
+    uint8_t inst[9];
+    uint8_t vol[9];
+    uint8_t speed[9];     // T nibble
+    bool    just_triggered[9]; // Prevent Tick 0 double-hit
 } RetriggerState;
 
 typedef struct {
-    uint8_t base_vol;
-    uint8_t note;
-    uint8_t inst;
-    uint8_t rate;         // Oscillation speed
-    uint8_t depth;        // Volume deviation
-    uint8_t waveform;     // 0=sine, 1=triangle, 2=square
-    uint8_t phase;        // Current wave position (0-255)
-    uint8_t tick_counter;
-    bool    active;
+    uint8_t note[9];
+    uint8_t inst[9];
+    uint8_t rate[9];      // Oscillation speed
+    uint8_t depth[9];     // Volume deviation
+    uint8_t waveform[9];  // LFO_*, see lfo.h
+    uint8_t phase_lo[9];  // Position in the wave, 8.8, as vibrato
+    uint8_t phase_hi[9];
 } TremoloState;
 
 typedef struct {
-    uint8_t base_note;
-    int8_t  detune;       // Signed detune in 1/32 semitones
-    uint8_t inst;
-    uint8_t vol;
-    bool    active;
+    uint8_t base_note[9];
+    int8_t  detune[9];    // Signed detune in 1/32 semitones
+    uint8_t inst[9];
+    uint8_t vol[9];
 } FinePitchState;
 
 typedef struct {
-    uint8_t base_note;
-    uint8_t inst;
-    uint8_t vol;
-    uint8_t scale;
-    uint8_t range;       // D nibble
-    uint8_t target_ticks;
-    uint8_t timer;
-    bool    active;
-    bool    just_triggered;
+    uint8_t base_note[9];
+    uint8_t inst[9];
+    uint8_t vol[9];
+    uint8_t scale[9];
+    uint8_t range[9];    // D nibble
+    uint8_t target_ticks_lo[9];
+    uint8_t target_ticks_hi[9];
+    uint8_t timer_lo[9];
+    uint8_t timer_hi[9];
+    bool    just_triggered[9];
+    uint8_t rng_lo[9];   // Xorshift state, never 0
+    uint8_t rng_hi[9];
 } GenState;
 
-extern ArpState ch_arp[9];
-extern PortamentoState ch_porta[9];
-extern VolumeSlideState ch_volslide[9];
-extern VibratoState ch_vibrato[9];
-extern NoteCutState ch_notecut[9];
-extern NoteDelayState ch_notedelay[9];
-extern RetriggerState ch_retrigger[9];
-extern TremoloState ch_tremolo[9];
-extern FinePitchState ch_finepitch[9];
-extern GenState ch_generator[9];
+// The generator's random notes come from a per-channel generator seeded
+// from song_gen_seed on every rewind, so a song plays the same "random"
+// line each time, live or exported. Saved with the song.
+#define GEN_DEFAULT_SEED 0xACE1
+
+extern uint16_t song_gen_seed;
+extern void gen_seed(void);
+
+// Arp step tables. A step is semitones above the root, or ARP_DEPTH for
+// the effect's D nibble. Songs carry up to SONG_ARP_TABLES of their own,
+// played with command B; a zero length marks an unused one.
+#define ARP_DEPTH       0xFF
+#define ARP_MAX_STEPS   16
+#define SONG_ARP_TABLES 8
+
+extern uint8_t song_arp_len[SONG_ARP_TABLES];
+extern uint8_t song_arp_steps[SONG_ARP_TABLES][ARP_MAX_STEPS];
+
+// Which engines are running, one word per channel. Bit order is the
+// order they run in each frame. Killing everything is ch_fx[ch] = 0.
+#define FX_ARP       0x0001
+#define FX_PORTA     0x0002
+#define FX_VOLSLIDE  0x0004
+#define FX_VIBRATO   0x0008
+#define FX_NOTECUT   0x0010
+#define FX_NOTEDELAY 0x0020
+#define FX_RETRIGGER 0x0040
+#define FX_TREMOLO   0x0080
+#define FX_FINEPITCH 0x0100  // Applied on trigger, no per-frame work
+#define FX_GEN       0x0200
+
+#define FX_COUNT     10
+#define FX_PER_FRAME (0x03FF & ~FX_FINEPITCH)
+
+extern uint16_t ch_fx[9];
+
+// Channels on the first tick of a row. Whoever plays the row on them (the
+// music, or the SFX player holding them) sets the bit, and it clears once
+// that tick's engines have run. Engines that leave tick 0 to the row's
+// own strike test this, so they run the same with the music stopped.
+extern uint16_t fx_row_start;
+
+// Pitch stage. Engines don't write A0/B0 themselves: a strike or a slide
+// sets the channel's note, modulation adds a fine offset for the frame,
+// and pitch_resolve() writes each changed channel once when the frame's
+// engines are done. So vibrato rides on a portamento instead of fighting
+// it for the register.
+typedef struct {
+    uint8_t note[9];    // Sounding note, semitone offsets included
+    int8_t  detune[9];  // The note's own fine offset (9xx), 1/32 semitone
+    uint8_t fine_lo[9]; // This frame's modulation, 1/32 semitone (int16_t)
+    uint8_t fine_hi[9];
+    uint8_t exact_lo[9]; // B0 (less key) and A0 of the note with no offset
+    uint8_t exact_hi[9];
+} PitchState;
+
+// Last write had a fine offset, or none yet. No note has F-number 0.
+#define PITCH_NOT_EXACT 0
+
+extern PitchState ch_pitch;
+extern uint16_t pitch_dirty;   // Channels to write at the end of the frame
+extern uint16_t pitch_key_on;  // ...and of those, the ones striking a note
+
+extern void pitch_strike(uint8_t ch, uint8_t note, int8_t detune);
+extern void pitch_glide(uint8_t ch, uint8_t note);
+extern void pitch_modulate(uint8_t ch, int16_t fine);
+extern void pitch_key_off(uint8_t ch);
+extern void pitch_restrike(uint8_t ch, uint8_t note);
+extern void pitch_resolve(void);
+
+// Volume stage, the same for the carrier's Total Level: strikes and the
+// volume slide set the channel's level, tremolo adds to it for the frame,
+// and volume_resolve() writes the result once, ahead of the pitch so a
+// new note keys on at its own level.
+typedef struct {
+    uint8_t level[9];   // 0-63: the note's volume, or where a slide is
+    int8_t  mod[9];     // This frame's modulation
+} VolumeState;
+
+extern VolumeState ch_volume;
+extern uint16_t volume_dirty;
+
+extern void volume_set(uint8_t ch, uint8_t vol);
+extern void volume_modulate(uint8_t ch, int8_t offset);
+extern void volume_resolve(void);
+
+extern ArpState ch_arp;
+extern PortamentoState ch_porta;
+extern VolumeSlideState ch_volslide;
+extern VibratoState ch_vibrato;
+extern NoteCutState ch_notecut;
+extern NoteDelayState ch_notedelay;
+extern RetriggerState ch_retrigger;
+extern TremoloState ch_tremolo;
+extern FinePitchState ch_finepitch;
+extern GenState ch_generator;
 
 extern void process_arp_logic(uint8_t ch);
 extern void process_portamento_logic(uint8_t ch);
@@ -129,9 +230,23 @@ extern void process_notecut_logic(uint8_t ch);
 extern void process_notedelay_logic(uint8_t ch);
 extern void process_retrigger_logic(uint8_t ch);
 extern void process_tremolo_logic(uint8_t ch);
-extern void process_finepitch_logic(uint8_t ch);
-extern int16_t get_arp_offset(uint8_t style, uint8_t depth, uint8_t index);
+extern uint8_t arp_offset(uint8_t ch);
 extern const uint8_t arp_tick_lut[16];
 extern void process_gen_logic(uint8_t ch);
 
+// Run one frame of every engine set in ch_fx[ch]
+extern void effects_run_channel(uint8_t ch);
+
+// Rebuild the tempo-scaled timing tables from seq.ticks_per_row_fp
+extern void effects_update_tempo(void);
+
+// Effect command dispatch: one parse entry per command nibble.
+// Returns true if the handler already struck the row's note.
+typedef bool (*EffectParseFn)(uint8_t ch, const PatternCell *cell);
+extern const EffectParseFn effect_parse_table[16];
+
+// Stop tremolo and put the channel's level back; stop every engine
+extern void tremolo_reset(uint8_t ch);
+extern void effects_reset_channel(uint8_t ch);
+
 #endif // EFFECTS_C
\ No newline at end of file
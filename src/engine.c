@@ -0,0 +1,217 @@
+#include <rp6502.h>
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef ENGINE_PROFILE
+#include <stdio.h>
+#endif
+#include "engine.h"
+#include "player.h"
+#include "sfx.h"
+#include "opl.h"
+
+volatile uint8_t engine_events = 0;
+bool engine_headless = false;
+volatile uint16_t engine_missed_frames = 0;
+volatile bool engine_hold = false;
+
+// Command ring: the UI owns cmd_head, the IRQ owns cmd_tail
+static EngineCmd cmd_ring[ENGINE_CMD_SLOTS];
+static volatile uint8_t cmd_head = 0;
+static volatile uint8_t cmd_tail = 0;
+
+static uint8_t irq_vsync_last;
+
+// 6502 IRQ vector. RAM on the RP6502, so it can be pointed at us at runtime.
+#define IRQ_VECTOR ((volatile uint16_t *)0xFFFE)
+
+// W65C22 VIA. Timer 1 clocks the engine above 60 Hz, timer 2 is the
+// free-running cycle counter of ENGINE_PROFILE builds.
+#define VIA_T1CL (*(volatile uint8_t *)0xFFD4)
+#define VIA_T1CH (*(volatile uint8_t *)0xFFD5)
+#define VIA_T1LL (*(volatile uint8_t *)0xFFD6)
+#define VIA_T1LH (*(volatile uint8_t *)0xFFD7)
+#define VIA_T2CL (*(volatile uint8_t *)0xFFD8)
+#define VIA_T2CH (*(volatile uint8_t *)0xFFD9)
+#define VIA_ACR  (*(volatile uint8_t *)0xFFDB)
+#define VIA_IFR  (*(volatile uint8_t *)0xFFDD)
+#define VIA_IER  (*(volatile uint8_t *)0xFFDE)
+#define VIA_T1_IRQ 0x40
+
+#if ENGINE_TICK_SHIFT > 0
+// The 16-bit timer can't reach 120 Hz at 8 MHz, so it may run at a
+// multiple of the tick rate and only every via_div-th interrupt ticks
+static uint8_t via_div = 1;
+static uint8_t via_count = 1;
+#endif
+
+#ifdef ENGINE_PROFILE
+uint16_t engine_prof_last[PROF_SLOTS];
+uint16_t engine_prof_worst[PROF_SLOTS];
+static uint16_t prof_bias;
+
+// Cycles since the counter was started. Timer 2 counts down, so this is
+// its complement; the high byte is read twice in case the low one wraps.
+uint16_t engine_prof_now(void) {
+    uint8_t hi, lo;
+    do {
+        hi = VIA_T2CH;
+        lo = VIA_T2CL;
+    } while (hi != VIA_T2CH);
+    return ~(((uint16_t)hi << 8) | lo);
+}
+
+void engine_prof_end(uint8_t slot, uint16_t start) {
+    uint16_t cycles = engine_prof_now() - start - prof_bias;
+    engine_prof_last[slot] = cycles;
+    if (cycles > engine_prof_worst[slot]) engine_prof_worst[slot] = cycles;
+}
+
+// UI side, with the sequencer stopped. Starts the next run from zero.
+void engine_prof_report(void) {
+    if (!engine_prof_worst[PROF_ROW]) return;
+    printf("PROFILE worst cycles: row %u, idle %u, effects %u\n",
+           engine_prof_worst[PROF_ROW], engine_prof_worst[PROF_IDLE],
+           engine_prof_worst[PROF_EFFECTS]);
+    for (uint8_t i = 0; i < PROF_SLOTS; i++) engine_prof_worst[i] = 0;
+}
+
+static void engine_prof_init(void) {
+    VIA_ACR &= ~0x20;  // T2 counts PHI2 cycles
+    VIA_T2CL = 0xFF;
+    VIA_T2CH = 0xFF;   // Starts it; it keeps counting down past zero
+
+    // An empty probe, taken off every measurement
+    uint16_t start = engine_prof_now();
+    prof_bias = engine_prof_now() - start;
+}
+#endif
+
+bool engine_post(uint8_t cmd, uint8_t arg) {
+    uint8_t next = (cmd_head + 1) & (ENGINE_CMD_SLOTS - 1);
+    if (next == cmd_tail) return false; // Full
+
+    // Fill the slot before publishing it
+    cmd_ring[cmd_head].cmd = cmd;
+    cmd_ring[cmd_head].arg = arg;
+    cmd_head = next;
+    return true;
+}
+
+static void engine_run_commands(void) {
+    if (cmd_tail == cmd_head) return;
+
+    do {
+        EngineCmd *c = &cmd_ring[cmd_tail];
+        switch (c->cmd) {
+            case ENGINE_CMD_PLAY:  sequencer_play();  break;
+            case ENGINE_CMD_PAUSE: sequencer_pause(); break;
+            case ENGINE_CMD_STOP:  sequencer_stop();  break;
+            case ENGINE_CMD_TEMPO:
+                seq.bpm = c->arg;
+                bpm_to_ticks_fp(seq.bpm);
+                break;
+            case ENGINE_CMD_MUTE:
+                sequencer_set_channels(channel_mask ^ (1u << c->arg));
+                break;
+            case ENGINE_CMD_SFX:   sfx_start(c->arg); break;
+            case ENGINE_CMD_SOLO:
+                sequencer_set_channels(channel_mask == (1u << c->arg)
+                                       ? CHANNEL_MASK_ALL : (1u << c->arg));
+                break;
+        }
+        cmd_tail = (cmd_tail + 1) & (ENGINE_CMD_SLOTS - 1);
+    } while (cmd_tail != cmd_head);
+
+    engine_post_event(ENGINE_EV_STATE);
+}
+
+uint8_t engine_take_events(void) {
+    // The IRQ may set a bit between our read and clear
+    engine_irq_off();
+    uint8_t ev = engine_events;
+    engine_events = 0;
+    engine_irq_restore();
+    return ev;
+}
+
+__attribute__((interrupt)) static void engine_irq(void) {
+#if ENGINE_TICK_SHIFT > 0
+    if (!(VIA_IFR & VIA_T1_IRQ)) return;
+    (void)VIA_T1CL; // Acknowledge
+    if (--via_count) return;
+    via_count = via_div;
+    uint8_t ticks = 1;
+#else
+    RIA.irq = 1; // Acknowledge, VSYNC IRQ stays enabled
+
+    // One tick per frame, and one for every frame we were kept from
+    uint8_t v = RIA.vsync;
+    uint8_t ticks = v - irq_vsync_last;
+    if (!ticks) return;
+    irq_vsync_last = v;
+#endif
+
+    if (engine_hold) return;
+
+    if (ticks > 1) {
+        engine_missed_frames += ticks - 1;
+        if (ticks > ENGINE_CATCHUP_MAX) ticks = ENGINE_CATCHUP_MAX;
+    }
+
+    // The UI may be halfway through a portal transfer
+    uint16_t addr0 = RIA.addr0;
+    int8_t step0 = RIA.step0;
+    uint16_t addr1 = RIA.addr1;
+    int8_t step1 = RIA.step1;
+
+    engine_run_commands();
+    do {
+        sfx_step();
+        sequencer_step();
+    } while (--ticks);
+    OPL_Flush(); // Catch-up ticks go out as one frame
+
+    RIA.step0 = step0;
+    RIA.addr0 = addr0;
+    RIA.step1 = step1;
+    RIA.addr1 = addr1;
+}
+
+void engine_init(void) {
+    irq_vsync_last = RIA.vsync;
+
+    asm volatile("sei" ::: "memory");
+#ifdef ENGINE_PROFILE
+    engine_prof_init();
+#endif
+    *IRQ_VECTOR = (uint16_t)engine_irq;
+#if ENGINE_TICK_SHIFT > 0
+    // Timer period in PHI2 cycles (free-run reloads take 2 more)
+    uint32_t period = (uint32_t)phi2() * 1000UL / ENGINE_TICK_HZ;
+    while (period > 0xFFFFUL) {
+        period >>= 1;
+        via_div <<= 1;
+    }
+    via_count = via_div;
+    period -= 2;
+
+    VIA_IER = VIA_T1_IRQ;               // Disable while we set it up
+    VIA_ACR = (VIA_ACR & 0x3F) | 0x40;  // T1 continuous, no PB7 output
+    VIA_T1LL = (uint8_t)period;
+    VIA_T1LH = (uint8_t)(period >> 8);
+    VIA_T1CH = (uint8_t)(period >> 8);  // Loads the counter and starts it
+    VIA_IER = 0x80 | VIA_T1_IRQ;        // Enable T1 IRQ
+#else
+    RIA.irq = 1; // Enable VSYNC IRQ
+#endif
+    asm volatile("cli" ::: "memory");
+}
+
+void engine_shutdown(void) {
+    asm volatile("sei" ::: "memory");
+#if ENGINE_TICK_SHIFT > 0
+    VIA_IER = VIA_T1_IRQ;
+#else
+    RIA.irq = 0;
+#endif
+}
@@ -0,0 +1,128 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// AUDIO ENGINE (IRQ)
+// ============================================================================
+// The sequencer and effect engines run from an interrupt, so the
+// UI loop can take as long as it likes to draw. The UI never changes
+// playback state directly; it posts commands to a small ring that the
+// IRQ drains before its tick, and takes the event flags the IRQ posts.
+// Each side only ever writes its own ring index, so no locking there.
+
+// Engine clock. At 60 Hz the engine ticks on the RIA VSYNC IRQ; 120, 240
+// and 480 Hz run it from VIA timer 1 for finer row and effect timing.
+// Everything tempo related counts in these ticks; effect speeds that are
+// defined per frame are spread over ENGINE_TICKS_PER_FRAME ticks.
+#ifndef ENGINE_TICK_HZ
+#define ENGINE_TICK_HZ 60
+#endif
+
+#if ENGINE_TICK_HZ == 60
+#define ENGINE_TICK_SHIFT 0
+#elif ENGINE_TICK_HZ == 120
+#define ENGINE_TICK_SHIFT 1
+#elif ENGINE_TICK_HZ == 240
+#define ENGINE_TICK_SHIFT 2
+#elif ENGINE_TICK_HZ == 480
+#define ENGINE_TICK_SHIFT 3
+#else
+#error "ENGINE_TICK_HZ must be 60, 120, 240 or 480"
+#endif
+
+#define ENGINE_TICKS_PER_FRAME (1 << ENGINE_TICK_SHIFT)
+
+// One engine tick in 8.8 frames, for the effect timers that count frames
+#define ENGINE_TICK_FP (256 >> ENGINE_TICK_SHIFT)
+
+// Commands from the UI, applied at the start of the next engine tick
+#define ENGINE_CMD_PLAY   1   // Start from the current position
+#define ENGINE_CMD_PAUSE  2   // Stop where we are
+#define ENGINE_CMD_STOP   3   // Stop, silence and rewind to the top
+#define ENGINE_CMD_TEMPO  4   // arg = BPM
+#define ENGINE_CMD_MUTE   5   // arg = channel, toggles its mute
+#define ENGINE_CMD_SOLO   6   // arg = channel, solo it or back to all
+#define ENGINE_CMD_SFX    7   // arg = SFX player slot queued by sfx_play()
+
+#define ENGINE_CMD_SLOTS  8   // Power of two
+
+typedef struct {
+    uint8_t cmd;
+    uint8_t arg;
+} EngineCmd;
+
+// Events for the UI. The sequencer sets them, the UI loop takes them
+// all at once with engine_take_events() and redraws only what moved.
+#define ENGINE_EV_ROW    0x01  // A row was played
+#define ENGINE_EV_ORDER  0x02  // Song mode moved to another order
+#define ENGINE_EV_STATE  0x04  // A command changed play state/tempo/mutes
+
+extern volatile uint8_t engine_events;
+
+// Headless: the sequencer posts no events and so leaves nothing for the
+// UI to redraw. For offline runs (export, seek) that draw once at the end.
+extern bool engine_headless;
+
+#define engine_post_event(ev) \
+    do { if (!engine_headless) engine_events |= (ev); } while (0)
+
+// Fetch and clear the pending events (UI side)
+extern uint8_t engine_take_events(void);
+
+// Written by the UI only. While set the IRQ skips its tick, so the
+// foreground may drive the sequencer itself (export) or replace the
+// state under it (song load, panic).
+extern volatile bool engine_hold;
+
+// VSYNC clock: frames that went by without their tick, because the IRQ
+// was held off (long sei sections, XRAM bursts). Up to ENGINE_CATCHUP_MAX
+// ticks are run back to back to catch up, so tempo stays exact; anything
+// beyond that is dropped. Written by the IRQ only.
+#define ENGINE_CATCHUP_MAX 4
+extern volatile uint16_t engine_missed_frames;
+
+// Interrupt mask for the few multi-write sequences the IRQ must not split.
+// Saves the I flag, so it nests and is safe inside the IRQ as well.
+// Host builds (tests/) have no IRQ to keep out.
+#ifdef __mos__
+#define engine_irq_off() asm volatile("php\n\tsei" ::: "memory")
+#define engine_irq_restore() asm volatile("plp" ::: "memory")
+#else
+#define engine_irq_off() ((void)0)
+#define engine_irq_restore() ((void)0)
+#endif
+
+// Cycle probes (ENGINE_PROFILE builds). VIA timer 2 free-runs at PHI2;
+// each probe keeps the last and the worst cycle count of its section,
+// less the cost of the probe itself. Sections over 65535 cycles wrap.
+// The worst counts go to the console when playback stops.
+#define PROF_ROW     0  // sequencer_step() on a row tick
+#define PROF_IDLE    1  // sequencer_step() between rows
+#define PROF_EFFECTS 2  // sequencer_run_effects(), part of either
+#define PROF_SLOTS   3
+
+#ifdef ENGINE_PROFILE
+extern uint16_t engine_prof_last[PROF_SLOTS];
+extern uint16_t engine_prof_worst[PROF_SLOTS];
+extern uint16_t engine_prof_now(void);
+extern void engine_prof_end(uint8_t slot, uint16_t start);
+extern void engine_prof_report(void);
+#else
+#define engine_prof_now() 0
+#define engine_prof_end(slot, start) ((void)(slot), (void)(start))
+#define engine_prof_report() ((void)0)
+#endif
+
+// Install the IRQ handler and start the engine clock
+extern void engine_init(void);
+
+// Stop the engine interrupt (before exit)
+extern void engine_shutdown(void);
+
+// Queue a command for the engine. Returns false if the ring is full.
+extern bool engine_post(uint8_t cmd, uint8_t arg);
+
+#endif // ENGINE_H
@@ -311,11 +311,27 @@ const OPL_Patch drum_bd    = { .m_ave=0x00, .m_ksl=0x0D, .m_atdec=0xE8, .m_susre
 const OPL_Patch drum_snare = { .m_ave=0x06, .m_ksl=0x00, .m_atdec=0xF0, .m_susrel=0xF0, .m_wave=0x00, .c_ave=0x00, .c_ksl=0x00, .c_atdec=0xF7, .c_susrel=0xF7, .c_wave=0x00, .feedback=0x0E };
 const OPL_Patch drum_hihat = { .m_ave=0x05, .m_ksl=0x00, .m_atdec=0xF0, .m_susrel=0x77, .m_wave=0x00, .c_ave=0x00, .c_ksl=0x00, .c_atdec=0xFA, .c_susrel=0xEA, .c_wave=0x00, .feedback=0x0E };
 
+static const uint8_t mod_offsets[] = {0x00,0x01,0x02,0x08,0x09,0x0A,0x10,0x11,0x12};
+static const uint8_t car_offsets[] = {0x03,0x04,0x05,0x0B,0x0C,0x0D,0x13,0x14,0x15};
+
+// The patch each channel was last loaded with. Steps that restrike the
+// same instrument skip the 11 writes. Anything that writes the operators
+// behind OPL_SetPatch's back must forget the channel.
+static const OPL_Patch* loaded_patch[9];
+
+void OPL_PatchForget(uint8_t channel) {
+    loaded_patch[channel] = 0;
+}
+
+void OPL_PatchCacheReset(void) {
+    for (uint8_t i = 0; i < 9; i++) loaded_patch[i] = 0;
+}
+
 // Ensure the Patch Setup hits the correct OPL2 operators
 void OPL_SetPatch(uint8_t channel, const OPL_Patch* p) {
-    static const uint8_t mod_offsets[] = {0x00,0x01,0x02,0x08,0x09,0x0A,0x10,0x11,0x12};
-    static const uint8_t car_offsets[] = {0x03,0x04,0x05,0x0B,0x0C,0x0D,0x13,0x14,0x15};
-    
+    if (loaded_patch[channel] == p) return;
+    loaded_patch[channel] = p;
+
     uint8_t m = mod_offsets[channel];
     uint8_t c = car_offsets[channel];
 
@@ -339,4 +355,22 @@ void OPL_SetPatch(uint8_t channel, const OPL_Patch* p) {
     shadow_ksl_m[channel] = p->m_ksl & 0xC0;
     shadow_ksl_c[channel] = p->c_ksl & 0xC0;
 
-}
\ No newline at end of file
+}
+
+// Read back what a channel is set to, from the register shadow
+void OPL_GetPatch(uint8_t channel, OPL_Patch* p) {
+    uint8_t m = mod_offsets[channel];
+    uint8_t c = car_offsets[channel];
+
+    p->m_ave    = opl_hardware_shadow[0x20 + m];
+    p->c_ave    = opl_hardware_shadow[0x20 + c];
+    p->m_ksl    = opl_hardware_shadow[0x40 + m];
+    p->c_ksl    = opl_hardware_shadow[0x40 + c];
+    p->m_atdec  = opl_hardware_shadow[0x60 + m];
+    p->c_atdec  = opl_hardware_shadow[0x60 + c];
+    p->m_susrel = opl_hardware_shadow[0x80 + m];
+    p->c_susrel = opl_hardware_shadow[0x80 + c];
+    p->m_wave   = opl_hardware_shadow[0xE0 + m];
+    p->c_wave   = opl_hardware_shadow[0xE0 + c];
+    p->feedback = opl_hardware_shadow[0xC0 + channel];
+}
@@ -16,5 +16,12 @@ extern const OPL_Patch drum_snare;
 extern const OPL_Patch drum_hihat;
 
 extern void OPL_SetPatch(uint8_t channel, const OPL_Patch* patch);
+extern void OPL_GetPatch(uint8_t channel, OPL_Patch* patch);
+
+// OPL_SetPatch() skips a patch the channel already has. Forget a channel
+// before loading a patch buffer whose contents have changed, and every
+// channel after the chip has been wiped.
+extern void OPL_PatchForget(uint8_t channel);
+extern void OPL_PatchCacheReset(void);
 
 #endif // INSTRUMENTS_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef LFO_H
+#define LFO_H
+
+#include <stdint.h>
+
+// ============================================================================
+// LOW FREQUENCY OSCILLATORS
+// ============================================================================
+// Shared by vibrato and tremolo. An LFO is an 8.8 phase accumulator whose
+// high byte indexes a 256-entry wavetable. The phase step is worked out
+// once per rate and tempo by lfo_phase_step(), and the depth is applied
+// with shifts, so a frame is an add, a lookup and lfo_scale().
+
+#define LFO_SINE     0
+#define LFO_TRIANGLE 1
+#define LFO_SQUARE   2
+#define LFO_SAW      3
+#define LFO_STEPPED  4  // 16 fixed scrambled levels, repeats each cycle
+#define LFO_WAVES    5
+
+extern const int8_t lfo_wave[LFO_WAVES][256];
+
+// Waveform for an effect's T nibble; anything past the table is square
+extern uint8_t lfo_shape(uint8_t t);
+
+// Phase step per frame for a rate nibble at the current tempo
+extern uint16_t lfo_phase_step(uint8_t rate);
+
+// Wave sample times a 0-15 depth, -1905..1905
+extern int16_t lfo_scale(int8_t w, uint8_t depth);
+
+#endif // LFO_H
@@ -11,6 +11,10 @@
 #include "song.h"
 #include "usb_hid_keys.h"
 #include "effects.h"
+#include "stream.h"
+#include "engine.h"
+#include "sched.h"
+#include "sfx.h"
 
 unsigned text_message_addr;         // Text message address
 
@@ -68,14 +72,129 @@ void init_patterns(void) {
         RIA.rw0 = 0; 
     }
 
+    stream_invalidate_all();
+    reset_effect_shadow();
     for (int i=0; i<9; i++) {
-        last_effect[i] = 0xFFFF;
-        ch_arp[i].active = false;
-        ch_porta[i].active = false;
+        ch_fx[i] &= ~(FX_ARP | FX_PORTA);
     }
 
 }
 
+// ============================================================================
+// MAIN LOOP TASKS
+// ============================================================================
+
+// Keyboard/MIDI scan and panic. Everything else reads the key states.
+static void task_keys(void) {
+    handle_input(); // This MUST update keystates AND prev_keystates
+    midi_task();
+
+    if (key_pressed(KEY_ESC)) {
+        engine_hold = true;
+        sfx_reset();
+        OPL_Panic();
+        engine_hold = false;
+        printf("PANIC: All notes killed.\n");
+    }
+}
+
+// Shortcuts, transport, navigation, editing and the piano keys
+static void task_commands(void) {
+    static uint8_t patch_chan = 0;
+
+    if (is_dialog_active) {
+        handle_filename_input();
+        return;
+    }
+
+    // Check for Shortcuts
+    if (is_ctrl_down()) {
+        if (key_pressed(KEY_S)) {
+            is_dialog_active = true;
+            is_saving = true;
+            dialog_pos = 0;
+            dialog_buffer[0] = '\0'; // Start with empty string
+        }
+        if (key_pressed(KEY_O)) {
+            is_dialog_active = true;
+            is_saving = false;
+            dialog_pos = 0;
+            dialog_buffer[0] = '\0';
+        }
+        if (key_pressed(KEY_Q)) {
+            engine_shutdown();
+            OPL_Panic();
+            exit(0);
+        }
+    }
+
+    // Check Transport (Play/Stop)
+    handle_transport_controls();
+
+    handle_navigation();
+    handle_editing(); // Check for backspace/delete
+
+    player_tick();
+
+    // SYNC: Ensure the OPL2 hardware channel we just moved into
+    // is loaded with our current "brush" instrument.
+    if (cur_channel != patch_chan) {
+        preview_patch(cur_channel, current_instrument);
+        patch_chan = cur_channel;
+    }
+}
+
+// The sequencer runs on the engine IRQ; catch up on what it played
+static void task_sequencer_ui(void) {
+    if (is_dialog_active) return;
+    sequencer_sync_ui();
+}
+
+// Deferred grid redraws (pattern switches, view changes, pastes)
+static void task_grid(void) {
+    if (render_grid_step()) {
+        // The rows drew over the cursor bar and playhead markers
+        update_cursor_visuals(cur_row, cur_row, cur_channel, cur_channel);
+        mark_playhead(play_row);
+    }
+}
+
+// Cursor and playhead. Compares against what is on screen, not against
+// last frame, so a frame that ran out of time loses nothing.
+static void task_cursor(void) {
+    static uint8_t drawn_row = 0;
+    static uint8_t drawn_chan = 0;
+    static bool drawn_edit_mode = false;
+
+    if (is_dialog_active) return;
+
+    // Playhead Visuals
+    if (play_row != last_p_row || !seq.is_playing) {
+        mark_playhead(play_row);
+        last_p_row = play_row;
+    }
+
+    // --- UI REFRESH: Row or Channel Movement
+    if (cur_row != drawn_row || cur_channel != drawn_chan || edit_mode != drawn_edit_mode) {
+        update_cursor_visuals(drawn_row, cur_row, drawn_chan, cur_channel);
+        mark_playhead(play_row);
+
+        // If something changed the edit mode we refresh the dashboard values.
+        if (edit_mode != drawn_edit_mode) {
+            update_dashboard();
+        }
+
+        drawn_row = cur_row;
+        drawn_chan = cur_channel;
+        drawn_edit_mode = edit_mode;
+    }
+}
+
+static void task_meters(void) {
+    if (is_dialog_active) return;
+    update_meters();
+}
+
 int main(void)
 {
     // 1. Hardware Initialization
@@ -98,7 +217,8 @@ int main(void)
     render_grid();       // Initial grid draw
     update_cursor_visuals(0, 0, 0 ,0); // Initial cursor at 0,0
     mark_playhead(0);
-    update_lfo_scaler(); // Set initial LFO scaler based on BPM
+    bpm_to_ticks_fp(seq.bpm); // Set initial LFO scaler and effect timings
+    gen_seed();               // Generator sequences, for jamming before a play
     
 
     // 4. Software Initialization
@@ -110,93 +230,18 @@ int main(void)
         OPL_SetPatch(i, &gm_bank[0]);
     }
 
-    uint8_t vsync_last = RIA.vsync;
-    uint8_t prev_row = 0;
-    uint8_t prev_chan = 0;
-    bool prev_edit_mode = false;
-
-    while (1) {
-        while (RIA.vsync == vsync_last);
-        vsync_last = RIA.vsync;
-
-        // --- LOGIC STAGE ---
-        prev_row = cur_row;
-        prev_chan = cur_channel;
-        prev_edit_mode = edit_mode; // Track if we toggled record mode
+    // 5. Start the audio engine; from here on it runs on VSYNC IRQ
+    engine_init();
 
-        // --- INPUT STAGE ---
-        handle_input(); // This MUST update keystates AND prev_keystates
-        midi_task();
-
-        if (key_pressed(KEY_ESC)) {
-            OPL_Panic();
-            printf("PANIC: All notes killed.\n");
-        }
-
-        if (is_dialog_active) {
-            handle_filename_input();
-        } else 
-        {
-            // Check for Shortcuts
-            if (is_ctrl_down()) {
-                if (key_pressed(KEY_S)) {
-                    is_dialog_active = true;
-                    is_saving = true;
-                    dialog_pos = 0;
-                    dialog_buffer[0] = '\0'; // Start with empty string
-                }
-                if (key_pressed(KEY_O)) {
-                    is_dialog_active = true;
-                    is_saving = false;
-                    dialog_pos = 0;
-                    dialog_buffer[0] = '\0';
-                }
-                if (key_pressed(KEY_Q)) {
-                    OPL_Panic();
-                    exit(0);
-                }
-            }
-
-            // Check Transport (Play/Stop)
-            handle_transport_controls();
-
-            handle_navigation();
-            handle_editing(); // Check for backspace/delete
-
-            // The Sequencer "Heartbeat"
-            sequencer_step();
-
-            player_tick();
-
-            // Always animate the meters every frame
-            update_meters();
-
-            // Playhead Visuals
-            if (play_row != last_p_row || !seq.is_playing) {
-                mark_playhead(play_row);
-                last_p_row = play_row;
-            }
-            
-            // --- UI REFRESH: Row or Channel Movement
-            if (cur_row != prev_row || cur_channel != prev_chan || edit_mode != prev_edit_mode) {
-                update_cursor_visuals(prev_row, cur_row, prev_chan, cur_channel);
-
-                mark_playhead(play_row);
-                
-                // SYNC: Ensure the OPL2 hardware channel we just moved into 
-                // is loaded with our current "brush" instrument.
-                if (cur_channel != prev_chan) {
-                    OPL_SetPatch(cur_channel, &gm_bank[current_instrument]);
-                }
-            }
-
-            // If something changed the instrument, octave, or edit mode
-            // we refresh the dashboard values.
-            if (edit_mode != prev_edit_mode) {
-                update_dashboard(); 
-            }
-
-        }
+    // 6. Main loop: see sched.h
+    sched_add(task_keys, SCHED_AUDIO);
+    sched_add(task_commands, SCHED_INPUT);
+    sched_add(task_sequencer_ui, SCHED_UI);
+    sched_add(task_grid, SCHED_UI);
+    sched_add(task_cursor, SCHED_UI);
+    sched_add(task_meters, SCHED_BACKGROUND);
 
+    while (1) {
+        sched_run_frame();
     }
 }
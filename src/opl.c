@@ -8,27 +8,13 @@
 #include "effects.h"
 #include "player.h"
 #include "screen.h"
-
-
-#ifdef USE_NATIVE_OPL2
-// F-Number table for Octave 4 @ 3.58 MHz
-const uint16_t fnum_table[12] = {
-    345, 365, 387, 410, 435, 460, 488, 517, 547, 580, 615, 651
-};
-#else
-// F-Number table for Octave 4 @ 4.0 MHz
-const uint16_t fnum_table[12] = {
-    // 308, 325, 345, 365, 387, 410, 434, 460, 487, 516, 547, 579
-    // 309, 327, 346, 367, 389, 412, 436, 462, 490, 519, 550, 583 <- 4 Mhz 
-    345, 365, 387, 410, 435, 460, 488, 517, 547, 580, 615, 651
-};
-#endif
+#include "engine.h"
 
 
 // Export State
 bool is_exporting = false;
 uint16_t export_idx = 0;       // Current offset in the XRAM buffer
-uint16_t accumulated_delay = 0; // Ticks since the last captured command
+uint16_t accumulated_delay = 0; // 60 Hz frames since the last captured command
 
 static bool export_pending_valid = false;
 static uint8_t export_pending_reg = 0;
@@ -63,6 +49,13 @@ uint8_t channel_is_drum[9] = {0,0,0,0,0,0,0,0,0};
 // Full shadow of the OPL2's 256 registers
 uint8_t opl_hardware_shadow[256];
 
+// Chase mode: writes land in the shadow only, the chip is left alone
+bool opl_silent = false;
+
+// What the chip held when a silent run started, see OPL_ShadowSync().
+// Deferred builds also keep the chip's value of each queued register here.
+static uint8_t opl_chip_copy[256];
+
 // Initialize shadow with a "dirty" value to force the first writes
 void OPL_ShadowReset() {
     for (int i = 0; i < 256; i++) {
@@ -84,34 +77,13 @@ uint8_t shadow_ksl_c[9];
 // Low Byte: F-Number Low (8 bits)
 uint16_t midi_to_opl_freq(uint8_t midi_note) {
     if (midi_note < 12) midi_note = 12;   // Lowest note is C-1
-    if (midi_note > 127) midi_note = 127; // Highest note is G9
-    
-    int block = (midi_note - 12) / 12;
-    int note_idx = (midi_note - 12) % 12;
-    
-    if (block > 7) block = 7;
-
-    uint16_t f_num = fnum_table[note_idx];
-    uint8_t high_byte = 0x20 | (block << 2) | ((f_num >> 8) & 0x03);
-    uint8_t low_byte = f_num & 0xFF;
+    if (midi_note > opl_note_max) midi_note = opl_note_max; // F#-8 on the RIA
 
-    return (high_byte << 8) | low_byte;
+    return ((uint16_t)(0x20 | opl_fnum_hi[midi_note]) << 8) | opl_fnum_lo[midi_note];
 }
 
-void OPL_Write(uint8_t reg, uint8_t data) {
-    // During export, always write note on/off commands (0xB0-0xB8)
-    // to ensure proper timing even if shadow thinks it's redundant
-    bool is_note_onoff_reg = (reg >= 0xB0 && reg <= 0xB8);
-    bool bypass_shadow = is_exporting && is_note_onoff_reg;
-    
-    // Check if the hardware already has this value
-    if (!bypass_shadow && opl_hardware_shadow[reg] == data) {
-        return;
-    }
-
-    // Update the shadow
-    opl_hardware_shadow[reg] = data;
-
+// Send one register to the chip, or to the export stream
+static void opl_emit(uint8_t reg, uint8_t data) {
     // Intercept for Binary Export
     if (is_exporting) {
         // Check if buffer would overflow
@@ -150,13 +122,122 @@ void OPL_Write(uint8_t reg, uint8_t data) {
     RIA.addr1 = OPL_ADDR + reg;
     RIA.rw1 = data;
 #else
+    // Register/data pair: the engine IRQ must not slip its own in between
+    engine_irq_off();
     RIA.addr1 = OPL_ADDR;
     RIA.step1 = 1;
     RIA.rw1 = reg;
     RIA.rw1 = data;
+    engine_irq_restore();
 #endif
 }
 
+#ifdef OPL_DEFER_WRITES
+// Deferred writes: OPL_Write only updates the shadow and marks the
+// register, and OPL_Flush() sends the frame's net changes in one go.
+// opl_chip_copy holds what the chip had for each marked register.
+static uint8_t opl_dirty[32];      // One bit per register
+static uint16_t opl_keyoff = 0;    // Channels keyed off at some point
+
+static void opl_defer(uint8_t reg, uint8_t data) {
+    // The foreground queues too (previews, panic): keep the IRQ out
+    engine_irq_off();
+    uint8_t bit = 1 << (reg & 7);
+    if (!(opl_dirty[reg >> 3] & bit)) {
+        opl_dirty[reg >> 3] |= bit;
+        opl_chip_copy[reg] = opl_hardware_shadow[reg];
+    }
+
+    // A key-off the chip has to see, even if the key is back on by the
+    // flush: that's what restarts the envelope
+    if (reg >= 0xB0 && reg <= 0xB8 && !(data & 0x20) && (opl_chip_copy[reg] & 0x20)) {
+        opl_keyoff |= 1u << (reg - 0xB0);
+    }
+    opl_hardware_shadow[reg] = data;
+    engine_irq_restore();
+}
+
+static bool opl_take_dirty(uint8_t reg) {
+    uint8_t bit = 1 << (reg & 7);
+    if (!(opl_dirty[reg >> 3] & bit)) return false;
+    opl_dirty[reg >> 3] &= ~bit;
+    return true;
+}
+
+static void opl_flush_reg(uint8_t reg) {
+    uint8_t data = opl_hardware_shadow[reg];
+    if (data == opl_chip_copy[reg]) return;
+    opl_chip_copy[reg] = data;
+    opl_emit(reg, data);
+}
+
+void OPL_Flush(void) {
+    engine_irq_off();
+
+    // 1. Key-offs, so nothing below changes under a sounding note. A
+    //    retrigger keys off at the old pitch; a note that stays off
+    //    gets its final value.
+    for (uint8_t ch = 0; ch < 9; ch++) {
+        uint8_t reg = 0xB0 + ch;
+        uint8_t bit = 1 << (reg & 7);
+        if (!(opl_dirty[reg >> 3] & bit)) continue;
+
+        if (!(opl_hardware_shadow[reg] & 0x20)) {
+            opl_take_dirty(reg);
+            opl_flush_reg(reg);
+        } else if (opl_keyoff & (1u << ch)) {
+            opl_chip_copy[reg] &= ~0x20;
+            opl_emit(reg, opl_chip_copy[reg]);
+        }
+    }
+    opl_keyoff = 0;
+
+    // 2. Patches, levels, feedback
+    for (uint8_t i = 0; i < 32; i++) {
+        if (!opl_dirty[i] || (i >= (0xA0 >> 3) && i <= (0xBF >> 3))) continue;
+        for (uint8_t reg = i << 3; opl_dirty[i]; reg++) {
+            if (opl_take_dirty(reg)) opl_flush_reg(reg);
+        }
+    }
+
+    // 3. F-numbers, then 4. block and key-on
+    for (uint8_t reg = 0xA0; reg <= 0xAF; reg++) {
+        if (opl_take_dirty(reg)) opl_flush_reg(reg);
+    }
+    for (uint8_t reg = 0xB0; reg <= 0xBF; reg++) {
+        if (opl_take_dirty(reg)) opl_flush_reg(reg);
+    }
+
+    engine_irq_restore();
+}
+#endif
+
+void OPL_Write(uint8_t reg, uint8_t data) {
+    // During export, always write note on/off commands (0xB0-0xB8)
+    // to ensure proper timing even if shadow thinks it's redundant
+    bool is_note_onoff_reg = (reg >= 0xB0 && reg <= 0xB8);
+    bool bypass_shadow = is_exporting && is_note_onoff_reg;
+    
+    // Check if the hardware already has this value
+    if (!bypass_shadow && opl_hardware_shadow[reg] == data) {
+        return;
+    }
+
+#ifdef OPL_DEFER_WRITES
+    if (!opl_silent) {
+        opl_defer(reg, data);
+        return;
+    }
+#endif
+
+    // Update the shadow
+    opl_hardware_shadow[reg] = data;
+
+    if (opl_silent) return;
+
+    opl_emit(reg, data);
+}
+
 void OPL_SilenceAll() {
     // Send Note-Off to all 9 channels
     // We let these go through the FIFO so they are timed correctly
@@ -188,44 +269,46 @@ void OPL_NoteOn(uint8_t channel, uint8_t midi_note) {
     shadow_b0[channel] = b0_value;  // Store FULL value including key-on bit
 }
 
-void OPL_SetPitch_Fine(uint8_t channel, uint8_t midi_note, int8_t fine_offset) {
+// Write a channel's pitch: a note plus a fine offset in 1/32 semitones,
+// interpolated between the F-numbers of the two semitones around it.
+// The key bit is set or cleared as asked; a glide passes the old one.
+void OPL_SetFrequency(uint8_t channel, uint8_t midi_note, int16_t fine, bool key_on) {
     if (channel > 8) return;
 
-    uint16_t freq = midi_to_opl_freq(midi_note);
-    uint16_t fnum = freq & 0x3FF; 
-    uint8_t block = (freq >> 10) & 0x07; 
+    if (channel_is_drum[channel]) {
+        midi_note = 60;
+    }
 
-    // --- THE BOOST ---
-    // Change multiplier from 2 to 4. 
-    // Now a fine_offset of 8 shifts the F-Number by 32 (approx 1 full semitone).
-    int16_t adjusted_fnum = (int16_t)fnum + (fine_offset * 4);
+    if (midi_note < 12) midi_note = 12;   // Lowest note is C-1
+    if (midi_note > opl_note_max) midi_note = opl_note_max; // F#-8 on the RIA
 
-    if (adjusted_fnum < 1) adjusted_fnum = 1;
-    if (adjusted_fnum > 1023) adjusted_fnum = 1023;
+    // Detuned below C-1 goes on down in block 0, at half the F-number
+    int16_t pos = ((int16_t)midi_note << 5) + fine;
+    if (pos < 0) pos = 0;
+    if (pos > ((int16_t)opl_note_max << 5)) pos = (int16_t)opl_note_max << 5;
+    uint8_t note = (uint8_t)(pos >> 5);
+    uint8_t frac = pos & 31;
 
-    OPL_Write(0xA0 + channel, adjusted_fnum & 0xFF);
-    uint8_t b_val = 0x20 | (block << 2) | ((adjusted_fnum >> 8) & 0x03);
-    OPL_Write(0xB0 + channel, b_val);
-    
-    shadow_b0[channel] = b_val & 0x1F;
+    // The step stays in the note's block and below F-number 1023
+    uint8_t hi = opl_fnum_hi[note];
+    uint16_t f_num = ((uint16_t)(hi & 0x03) << 8) | opl_fnum_lo[note];
+    if (frac) f_num += (opl_fine_step[note] * frac) >> 5;
+
+    uint8_t b0_value = (hi & 0x1C) | (uint8_t)(f_num >> 8);
+    if (key_on) b0_value |= 0x20;
+
+    OPL_Write(0xA0 + channel, f_num & 0xFF);
+    OPL_Write(0xB0 + channel, b0_value);
+    shadow_b0[channel] = b0_value;
 }
 
-void OPL_SetPitch(uint8_t channel, uint8_t midi_note) {
+// Key on at whatever pitch the channel already has: one write
+void OPL_KeyOn(uint8_t channel) {
     if (channel > 8) return;
 
-    // Change pitch without retriggering the note
-    // Keeps the key-on bit from shadow_b0
-    if (channel_is_drum[channel]) {
-        midi_note = 60;
-    }
-    
-    uint16_t freq = midi_to_opl_freq(midi_note);
-    uint8_t block_fnum_high = (freq >> 8) & 0x1F;
-    
-    OPL_Write(0xA0 + channel, freq & 0xFF);
-    // Preserve key-on bit (bit 5) from shadow
-    OPL_Write(0xB0 + channel, block_fnum_high | (shadow_b0[channel] & 0x20));
-    shadow_b0[channel] = (shadow_b0[channel] & 0x20) | block_fnum_high;
+    uint8_t b0_value = shadow_b0[channel] | 0x20;
+    OPL_Write(0xB0 + channel, b0_value);
+    shadow_b0[channel] = b0_value;
 }
 
 void OPL_NoteOff(uint8_t channel) {
@@ -249,6 +332,7 @@ void OPL_Clear() {
     }
     // Reset shadow memory
     for (int i=0; i<9; i++) shadow_b0[i] = 0;
+    OPL_PatchCacheReset();
 }
 
 void OPL_SetVolume(uint8_t chan, uint8_t velocity) {
@@ -286,10 +370,12 @@ void OPL_Init() {
         channel_is_drum[i] = 0;
         shadow_b0[i] = 0;
     }
+    OPL_PatchCacheReset();
 
     // Re-enable the features we need
     OPL_Write(0x01, 0x20); // Enable Waveform Select
     OPL_Write(0xBD, 0x00); // Ensure Melodic Mode
+    OPL_Flush();           // A reset goes out now, not with the next frame
 }
 
 void OPL_Silence() {
@@ -330,66 +416,58 @@ void OPL_Config(uint8_t enable, uint16_t addr) {
     
 }
 
-void OPL_NoteOn_Detuned(uint8_t channel, uint8_t midi_note, int8_t detune) {
-    if (channel > 8) return;
-
-    // Consistency with OPL_NoteOn: if drum, base pitch is fixed to Middle C
-    if (channel_is_drum[channel]) {
-        midi_note = 60; 
-    }
-
-    uint16_t freq = midi_to_opl_freq(midi_note);
-    uint16_t fnum = freq & 0x3FF; 
-    uint8_t block = (freq >> 10) & 0x07; 
-
-    // Convert to linear frequency scalar (Fnum * 2^Block)
-    // capable of representing the full frequency range
-    uint32_t v = (uint32_t)fnum << block;
-
-    // Apply detune (1/32 semitone steps)
-    // Formula approximation: v_new = v * (1 + detune/384 * ln(2))
-    // constant 554 ~= 384 / ln(2)
-    int32_t delta = ((int32_t)v * detune) / 554;
-    int32_t v_new = (int32_t)v + delta;
-
-    if (v_new < 1) v_new = 1;
-
-    // Re-encode into optimal Block/F-Num to maximize precision
-    // We find the lowest block that allows the F-Num to fit in 10 bits
-    uint8_t new_block = 0;
-    while ((v_new >> new_block) > 1023 && new_block < 7) {
-        new_block++;
-    }
-
-    uint16_t new_fnum = (uint16_t)(v_new >> new_block);
-    if (new_fnum > 1023) new_fnum = 1023; // Clamp at physical max
-
-    OPL_Write(0xA0 + channel, new_fnum & 0xFF);
-    uint8_t b_val = 0x20 | (new_block << 2) | ((new_fnum >> 8) & 0x03);
-    OPL_Write(0xB0 + channel, b_val);
-    
-    shadow_b0[channel] = b_val & 0x1F;
-}
-
 void OPL_Write_Force(uint8_t reg, uint8_t data) {
     // We update the shadow so it stays in sync, 
     // but we DO NOT check it to skip the write.
     opl_hardware_shadow[reg] = data;
+#ifdef OPL_DEFER_WRITES
+    opl_chip_copy[reg] = data; // A queued write to it is now a no-op
+#endif
 
 #ifdef USE_NATIVE_OPL2
     RIA.addr1 = OPL_ADDR + reg;
     RIA.rw1 = data;
 #else
+    // Register/data pair: the engine IRQ must not slip its own in between
+    engine_irq_off();
     RIA.addr1 = OPL_ADDR;
     RIA.step1 = 1;
     RIA.rw1 = reg;
     RIA.rw1 = data;
+    engine_irq_restore();
 #endif
 }
 
+void OPL_ShadowSnapshot(void) {
+    OPL_Flush(); // The copy must be what the chip really has
+    for (int i = 0; i < 256; i++) {
+        opl_chip_copy[i] = opl_hardware_shadow[i];
+    }
+}
+
+void OPL_ShadowSync(void) {
+    // Patches, levels and F-numbers first...
+    for (int i = 0; i < 256; i++) {
+        if (i >= 0xB0 && i <= 0xB8) continue;
+        if (opl_hardware_shadow[i] != opl_chip_copy[i]) {
+            OPL_Write_Force(i, opl_hardware_shadow[i]);
+        }
+    }
+
+    // ...then key-on, so every voice sounds fully set up
+    for (uint8_t i = 0xB0; i <= 0xB8; i++) {
+        if (opl_hardware_shadow[i] != opl_chip_copy[i]) {
+            OPL_Write_Force(i, opl_hardware_shadow[i]);
+        }
+    }
+}
+
 void OPL_Panic(void) {
     static const uint8_t car_offsets[] = {0x03, 0x04, 0x05, 0x0B, 0x0C, 0x0D, 0x13, 0x14, 0x15};
     
+    // Nothing queued may land after the mute
+    OPL_Flush();
+
     // Stop the sequencer if it's running
     seq.is_playing = false;
 
@@ -402,12 +480,8 @@ void OPL_Panic(void) {
         OPL_Write_Force(0x40 + car_offsets[i], 0x3F);
 
         // 3. Kill ALL Logic Engines for this channel
-        ch_arp[i].active = false;
-        ch_vibrato[i].active = false;
-        ch_volslide[i].active = false;
-        ch_porta[i].active = false;
-        ch_retrigger[i].active = false;
-        ch_notecut[i].active = false;
+        ch_fx[i] &= ~(FX_ARP | FX_VIBRATO | FX_VOLSLIDE | FX_PORTA |
+                      FX_RETRIGGER | FX_NOTECUT);
         
         // 4. Reset internal software trackers
         shadow_b0[i] = 0;
@@ -418,7 +492,8 @@ void OPL_Panic(void) {
     active_midi_note = 0;
     
     // 6. Reset Effect Shadowing so the next note is forced to send everything
-    for (int i = 0; i < 9; i++) last_effect[i] = 0xFFFF;
+    reset_effect_shadow();
+    OPL_PatchCacheReset();
 
     printf("PANIC: Hardware Muted & Logic Reset.\n");
 }
@@ -23,17 +23,42 @@ extern bool is_exporting;
 extern uint16_t export_idx;
 extern uint16_t accumulated_delay;
 
+// Chase-seek: while set, OPL_Write only updates the shadow.
+// Snapshot before the silent run, sync after it to send the chip
+// just the registers that changed.
+extern bool opl_silent;
+extern void OPL_ShadowSnapshot(void);
+extern void OPL_ShadowSync(void);
+
+// Deferred writes (OPL_DEFER_WRITES builds): OPL_Write updates the shadow
+// and queues the register; OPL_Flush() sends the net change of each one
+// at the end of the frame, key-offs first, then patches and levels, then
+// F-numbers and key-ons. A note keyed off and on again within the frame
+// still gets both, so retriggers restart the envelope.
+#ifdef OPL_DEFER_WRITES
+extern void OPL_Flush(void);
+#else
+#define OPL_Flush() ((void)0)
+#endif
+
 extern void OPL_ExportFlushPending(void);
 extern void OPL_ExportResetPending(void);
 
-extern const uint16_t fnum_table[12];
+// Note tables for the build's OPL clock, generated into opl_freq.c by
+// tools/gen_opl_freq.py: A0, B0 less the key bit, and the F-number step
+// to the next semitone in the same block. Notes above opl_note_max would
+// all clamp to F-number 1023, so they play at opl_note_max instead.
+extern const uint8_t opl_fnum_lo[128];
+extern const uint8_t opl_fnum_hi[128];
+extern const uint8_t opl_fine_step[128];
+extern const uint8_t opl_note_max;
 
 extern uint16_t current_event_idx;
 extern uint16_t ticks_until_next_event;
 
 extern void OPL_NoteOn(uint8_t channel, uint8_t midi_note);
+extern void OPL_KeyOn(uint8_t channel);
 extern void OPL_NoteOff(uint8_t channel);
-extern void OPL_SetPitch(uint8_t channel, uint8_t midi_note); // Change pitch without retriggering
 extern void OPL_Clear();
 extern void OPL_Write(uint8_t reg, uint8_t value);
 extern void OPL_SetVolume(uint8_t chan, uint8_t velocity);
@@ -41,9 +66,7 @@ extern void OPL_Init();
 extern void OPL_FifoClear();
 extern void OPL_SilenceAll();
 extern void OPL_Config(uint8_t enable, uint16_t addr);
-extern void OPL_SetPitch(uint8_t channel, uint8_t midi_note);
-extern void OPL_SetPitch_Fine(uint8_t channel, uint8_t midi_note, int8_t fine_offset);
-extern void OPL_NoteOn_Detuned(uint8_t channel, uint8_t midi_note, int8_t detune);
+extern void OPL_SetFrequency(uint8_t channel, uint8_t midi_note, int16_t fine, bool key_on);
 extern void OPL_Panic();
 
 #endif // OPL_H
\ No newline at end of file
@@ -11,17 +11,20 @@
 #include "instruments.h"
 #include "song.h"
 #include "effects.h"
+#include "stream.h"
+#include "engine.h"
+#include "sfx.h"
 
 
 // Unity (1.0) is 256. 
-// This scales LFO speeds relative to our 150 BPM baseline.
+// This scales LFO speeds (per frame) relative to our 150 BPM baseline.
 uint16_t lfo_tempo_scaler = 256;
 
 void update_lfo_scaler(void) {
     // Math: (Baseline_FP << 8) / Current_FP
-    // 1536 << 8 = 393216
+    // 1536 << 8 = 393216, baseline is 6 frames' worth of engine ticks
     if (seq.ticks_per_row_fp > 0) {
-        lfo_tempo_scaler = (uint16_t)(393216L / seq.ticks_per_row_fp);
+        lfo_tempo_scaler = (uint16_t)((393216L << ENGINE_TICK_SHIFT) / seq.ticks_per_row_fp);
     }
 }
 
@@ -29,8 +32,19 @@ void update_lfo_scaler(void) {
 bool effect_view_mode = false;
 uint16_t last_effect[9] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF};
 
+// Bit per channel whose last_effect is non-zero. Empty cells are not in the
+// event stream, but one still has to clear the shadow on these channels.
+static uint16_t effect_shadow_mask = 0x1FF;
+
+// Force the next effect on every channel to be parsed again
+void reset_effect_shadow(void) {
+    for (uint8_t i = 0; i < 9; i++) last_effect[i] = 0xFFFF;
+    effect_shadow_mask = 0x1FF;
+}
+
 // Playback Options
 bool is_follow_mode = true;
+uint16_t channel_mask = CHANNEL_MASK_ALL;
 uint8_t play_row = 0; // The actual row being played by the engine
 
 // Current State
@@ -45,21 +59,38 @@ static int export_fd = -1;
 static uint32_t export_total_bytes = 0;
 static bool export_song_ended = false;
 
+// XRAM base offsets for every pattern and row, so cell addressing is two
+// table lookups instead of two 16-bit multiplies on the 6502.
+// pattern_xram_offset[p] = p * PATTERN_SIZE (1440)
+static const uint16_t pattern_xram_offset[MAX_PATTERNS] = {
+    0, 1440, 2880, 4320, 5760, 7200, 8640, 10080,
+    11520, 12960, 14400, 15840, 17280, 18720, 20160, 21600,
+    23040, 24480, 25920, 27360, 28800, 30240, 31680, 33120,
+    34560, 36000, 37440, 38880, 40320, 41760, 43200, 44640
+};
+
+// row_xram_offset[r] = r * ROW_SIZE (45)
+static const uint16_t row_xram_offset[32] = {
+    0, 45, 90, 135, 180, 225, 270, 315,
+    360, 405, 450, 495, 540, 585, 630, 675,
+    720, 765, 810, 855, 900, 945, 990, 1035,
+    1080, 1125, 1170, 1215, 1260, 1305, 1350, 1395
+};
+
+uint16_t get_row_xram_addr(uint8_t pat, uint8_t row) {
+    return pattern_xram_offset[pat] + row_xram_offset[row];
+}
+
 uint16_t get_pattern_xram_addr(uint8_t pat, uint8_t row, uint8_t chan) {
     // addr = (pat * 1440) + (row * 45) + (chan * 5)
-    // 1440 is 0x05A0
-    uint16_t p_off = (uint16_t)pat * 1440U;
-    // 45 is 0x2D
-    uint16_t r_off = (uint16_t)row * 45U;
-    
-    return p_off + r_off + (chan * 5U);
+    return get_row_xram_addr(pat, row) + (chan * CELL_SIZE);
 }
 
 static uint8_t pattern_clipboard[PATTERN_SIZE];
 static bool clipboard_full = false;
 
-// Initialize: 150 BPM = 6.0 ticks/row in 8.8 fixed-point = 0x0600 (1536)
-SequencerState seq = {false, 0x0600, 0, 150};
+// Initialize: 150 BPM = 6.0 frames/row in 8.8 fixed-point = 0x0600 (1536)
+SequencerState seq = {false, 0x0600 << ENGINE_TICK_SHIFT, 0, 150};
 
 #define KEY_REPEAT_DELAY 20 // Frames before repeat starts
 #define KEY_REPEAT_RATE  4  // Frames between repeats
@@ -99,16 +130,48 @@ static int8_t get_semitone(uint8_t scancode) {
 // Convert BPM to 8.8 fixed-point ticks_per_row
 // Formula: frames_per_row = 3600 frames/min / (BPM * 4 rows/beat)
 //        = 900 / BPM (in 8.8 fixed point: * 256 = 230400 / BPM)
+// times ENGINE_TICKS_PER_FRAME engine ticks per frame. Fits in 16 bits
+// down to 60 BPM even at 480 Hz.
+// Also rebuilds everything derived from the tempo, so this is the only
+// place the 32-bit tempo math runs.
 uint16_t bpm_to_ticks_fp(uint8_t bpm) {
     if (bpm < 60) bpm = 60;
     if (bpm > 240) bpm = 240;
     
     // Use 32-bit math to avoid overflow: (900 * 256) / bpm
-    uint32_t ticks = ((uint32_t)230400) / bpm;
-    return (uint16_t)ticks;
+    uint32_t ticks = ((uint32_t)230400 << ENGINE_TICK_SHIFT) / bpm;
+    seq.ticks_per_row_fp = (uint16_t)ticks;
 
-    // Update LFO scaler
+    // Update LFO scaler and effect timing tables
     update_lfo_scaler();
+    effects_update_tempo();
+    return seq.ticks_per_row_fp;
+}
+
+// ============================================================================
+// SONG TIMELINE
+// ============================================================================
+// Every order is 32 rows and the tempo is global, so the offset of any
+// row in the song is a multiply, not a walk over the order list.
+
+// Engine ticks from the start of the song to row `row_idx` (order * 32 + row).
+// Row n is struck ceil(n * ticks_per_row) ticks after row 0.
+uint32_t song_row_ticks(uint16_t row_idx) {
+    return ((uint32_t)row_idx * seq.ticks_per_row_fp + (TICK_SCALE - 1)) >> 8;
+}
+
+uint32_t song_order_ticks(uint8_t order) {
+    return song_row_ticks((uint16_t)order << 5);
+}
+
+// Length of one pass: the whole song, or the pattern being looped
+uint32_t song_total_ticks(void) {
+    return song_row_ticks(is_song_mode ? (song_length << 5) : 32);
+}
+
+// Where the sequencer currently is
+uint32_t song_elapsed_ticks(void) {
+    return song_row_ticks(is_song_mode ? ((uint16_t)cur_order_idx << 5) + play_row : play_row);
 }
 
 // ============================================================================
@@ -126,6 +189,42 @@ static void flush_export_buffer(void) {
     export_idx = 0;
 }
 
+// Back to row 0 (order 0 in song mode) with every effect cleared,
+// playing, so the next sequencer_step() processes row 0 immediately
+static void sequencer_rewind(void) {
+    sfx_reset();
+    cur_order_idx = 0;
+    play_row = 0;
+    seq.is_playing = true;
+    // Set to ticks_per_row_fp so first sequencer_step() processes row 0 immediately
+    // (matches behavior of pressing Enter to start playback)
+    seq.tick_counter_fp = seq.ticks_per_row_fp;
+    
+    // Clear all effect states. All of it, not just the engine bits in ch_fx:
+    // a chase-seek must land on the same state however it got there.
+    reset_effect_shadow();
+    memset(&ch_arp, 0, sizeof(ch_arp));
+    memset(&ch_porta, 0, sizeof(ch_porta));
+    memset(&ch_volslide, 0, sizeof(ch_volslide));
+    memset(&ch_vibrato, 0, sizeof(ch_vibrato));
+    memset(&ch_notecut, 0, sizeof(ch_notecut));
+    memset(&ch_notedelay, 0, sizeof(ch_notedelay));
+    memset(&ch_retrigger, 0, sizeof(ch_retrigger));
+    memset(&ch_tremolo, 0, sizeof(ch_tremolo));
+    memset(&ch_finepitch, 0, sizeof(ch_finepitch));
+    memset(&ch_generator, 0, sizeof(ch_generator));
+    gen_seed();
+    memset(ch_fx, 0, sizeof(ch_fx));
+    memset(&ch_pitch, 0, sizeof(ch_pitch));
+    pitch_dirty = 0;
+    pitch_key_on = 0;
+    memset(&ch_volume, 0, sizeof(ch_volume));
+    volume_dirty = 0;
+    
+    // Load first pattern
+    if (is_song_mode) cur_pattern = read_order_xram(cur_order_idx);
+}
+
 static void derive_export_filename(void) {
     // Start with the active tracker filename
     if (active_filename[0] == '\0') {
@@ -174,30 +273,8 @@ static void start_export(void) {
     
     // Force song mode and reset to beginning
     is_song_mode = true;
-    cur_order_idx = 0;
-    play_row = 0;
-    seq.is_playing = true;
-    // Set to ticks_per_row_fp so first sequencer_step() processes row 0 immediately
-    // (matches behavior of pressing Enter to start playback)
-    seq.tick_counter_fp = seq.ticks_per_row_fp;
-    
-    // Clear all effect states
-    for (int i = 0; i < 9; i++) {
-        last_effect[i] = 0xFFFF;
-        ch_arp[i].active = false;
-        ch_porta[i].active = false;
-        ch_volslide[i].active = false;
-        ch_vibrato[i].active = false;
-        ch_notecut[i].active = false;
-        ch_notedelay[i].active = false;
-        ch_retrigger[i].active = false;
-        ch_tremolo[i].active = false;
-        ch_finepitch[i].active = false;
-        ch_generator[i].active = false;
-    }
-    
-    // Load first pattern
-    cur_pattern = read_order_xram(cur_order_idx);
+    sequencer_rewind();
+    OPL_Flush(); // The reset goes out ahead of the first tick
     
     printf("Exporting song...\n");
 }
@@ -205,6 +282,7 @@ static void start_export(void) {
 static void finish_export(void) {
     // 1. Wipe the OPL2 registers so hanging notes don't bleed into the loop
     OPL_Clear();
+    OPL_Flush();
     
     // Flush the very last pending packet emitted by OPL_Clear
     OPL_ExportFlushPending();
@@ -258,40 +336,57 @@ static void finish_export(void) {
     printf("File: %s\n", export_filename);
 }
 
-static void process_per_frame_effects(void) {
-    for (uint8_t ch = 0; ch < 9; ch++) {
-        process_arp_logic(ch);
-        process_portamento_logic(ch);
-        process_volume_slide_logic(ch);
-        process_vibrato_logic(ch);
-        process_notecut_logic(ch);
-        process_notedelay_logic(ch);
-        process_retrigger_logic(ch);
-        process_tremolo_logic(ch);
-        process_finepitch_logic(ch);
-        process_gen_logic(ch);
+// Per-frame effect engines for the channels in `mask`
+void sequencer_run_effects(uint16_t mask) {
+    uint16_t on = mask;
+    for (uint8_t ch = 0; ch < 9; ch++, on >>= 1) {
+        if (!(on & 1)) continue; // Muted: no engine runs at all
+        if (ch_fx[ch]) effects_run_channel(ch);
     }
+
+    // Strikes from the row and the engines: one TL, then one A0/B0
+    // write per channel
+    if (volume_dirty) volume_resolve();
+    if (pitch_dirty) pitch_resolve();
+
+    // One run per engine tick, whoever's row it started
+    fx_row_start = 0;
 }
 
 static void export_loop(void) {
     // Track starting order to detect loop
     uint8_t start_order = cur_order_idx;
     bool seen_end = false;
+    uint8_t last_order = cur_order_idx;
+    uint32_t total = song_total_ticks();
+    uint8_t sub_tick = 0;
     
     // Run sequencer until song ends
     while (is_exporting) {
-        // Increment delay counter each frame
-        accumulated_delay++;
+        // .BIN delays are in 60 Hz frames whatever ENGINE_TICK_HZ is, so
+        // files play the same in any player. A faster engine counts one
+        // frame per ENGINE_TICKS_PER_FRAME ticks, and the writes of the
+        // frame's later ticks go out with it.
+        if (sub_tick == 0) accumulated_delay++;
+        sub_tick = (sub_tick + 1) & (ENGINE_TICKS_PER_FRAME - 1);
         
         // Run sequencer step — this already runs all per-frame effects in Phase B
         // (arp, portamento, vibrato, notecut, etc.), exactly as live playback does.
         sequencer_step();
+        OPL_Flush();
         
         // Check if buffer is getting full (leave room for end marker)
         if (export_idx >= (EXPORT_CHUNK - 8)) {
             flush_export_buffer();
         }
         
+        if (cur_order_idx != last_order) {
+            last_order = cur_order_idx;
+            if (cur_order_idx) {
+                printf("Export: %u%%\n", (unsigned)(song_order_ticks(cur_order_idx) * 100 / total));
+            }
+        }
+
         // Detect song end: when cur_order_idx wraps back to 0 after reaching song_length
         if (cur_order_idx >= song_length - 1) {
             seen_end = true;
@@ -312,6 +407,47 @@ static void export_loop(void) {
     }
 }
 
+// Binary export. The foreground drives the sequencer itself, as fast as
+// it can, so the IRQ has to keep out.
+void export_song(void) {
+    engine_hold = true;
+    engine_headless = true;
+    start_export();
+    export_loop();
+    engine_headless = false;
+    engine_hold = false;
+}
+
+// Live previews share the chip, its shadows and the patch cache with the
+// engine, so they go out with the IRQ held off, as do the effect kills
+// (ch_fx is a 16-bit read-modify-write the IRQ could land in).
+static void preview_note(uint8_t ch, uint8_t inst, uint8_t vol, uint8_t note) {
+    engine_irq_off();
+    OPL_NoteOff(ch);
+    OPL_SetPatch(ch, &gm_bank[inst]);
+    OPL_SetVolume(ch, vol << 1);
+    OPL_NoteOn(ch, note);
+    engine_irq_restore();
+}
+
+static void preview_note_off(uint8_t ch) {
+    engine_irq_off();
+    OPL_NoteOff(ch);
+    engine_irq_restore();
+}
+
+void preview_patch(uint8_t ch, uint8_t inst) {
+    engine_irq_off();
+    OPL_SetPatch(ch, &gm_bank[inst]);
+    engine_irq_restore();
+}
+
+static void preview_kill_fx(uint8_t ch) {
+    engine_irq_off();
+    ch_fx[ch] &= ~(FX_ARP | FX_VIBRATO);
+    engine_irq_restore();
+}
+
 void player_tick(void) {
     uint8_t channel = cur_channel; // Map piano to the active grid channel
     bool note_pressed_this_frame = false;
@@ -328,15 +464,34 @@ void player_tick(void) {
         if (key_pressed(KEY_V)) {
             pattern_paste(cur_pattern);
         }
+        if (key_pressed(KEY_M)) {
+            // Ctrl+M mutes the cursor channel, Ctrl+Shift+M solos it
+            engine_post(is_shift_down() ? ENGINE_CMD_SOLO : ENGINE_CMD_MUTE,
+                        cur_channel);
+        }
+        if (key_pressed(KEY_R)) {
+            // Ctrl+R rerolls the generator seed, Ctrl+Shift+R goes back to
+            // the default. Saved with the song; heard from the next note.
+            uint16_t s = GEN_DEFAULT_SEED;
+            if (!is_shift_down()) {
+                s = (uint16_t)(song_gen_seed * 5 + 0x3A7D) ^ ((uint16_t)RIA.vsync << 8);
+                if (!s) s = GEN_DEFAULT_SEED;
+            }
+            engine_irq_off();
+            song_gen_seed = s;
+            gen_seed();
+            engine_irq_restore();
+            printf("Generator seed: %04X\n", s);
+        }
         if (key_pressed(KEY_E)) {
-            // Start binary export
-            start_export();
-            export_loop();
+            export_song();
+            render_grid_deferred();
+            update_dashboard();
             return;
         }
         
         if (active_midi_note != 0) {
-            OPL_NoteOff(channel);
+            preview_note_off(channel);
             active_midi_note = 0;
         }
         return; 
@@ -350,8 +505,8 @@ void player_tick(void) {
                 semitone = s;
                 target_note = (current_octave + 1) * 12 + semitone;
                 note_pressed_this_frame = true;
-                ch_arp[channel].active = false; // Keyboard input kills any background Arp
-                ch_vibrato[channel].active = false; // Keyboard input kills vibrato
+                // Keyboard input kills any background Arp and vibrato
+                preview_kill_fx(channel);
                 break;
             }
         }
@@ -365,19 +520,17 @@ void player_tick(void) {
         if (!live_volume)
             live_volume = 1;
         note_pressed_this_frame = true;
-        ch_arp[channel].active = false;
-        ch_vibrato[channel].active = false;
+        preview_kill_fx(channel);
     }
 
+    // Nothing goes in above the note table's top: it would all be one pitch
+    if (target_note > opl_note_max) note_pressed_this_frame = false;
+
     // 2. Logic: Note On & Recording
     if (note_pressed_this_frame) {
         if (target_note != active_midi_note || midi_fresh) {
             // Live Overdrive: Cut the sequencer's note and play the keyboard note
-            OPL_NoteOff(channel);
-            // ch_peaks[channel] = 0; // Clear peak
-            OPL_SetPatch(channel, &gm_bank[current_instrument]);
-            OPL_SetVolume(channel, live_volume << 1);
-            OPL_NoteOn(channel, target_note);
+            preview_note(channel, current_instrument, live_volume, target_note);
             ch_peaks[channel] = live_volume; // Set peak for meter display
             active_midi_note = target_note;
 
@@ -411,7 +564,7 @@ void player_tick(void) {
     else {
         if (active_midi_note != 0) {
             if (!seq.is_playing) {
-                OPL_NoteOff(channel);
+                preview_note_off(channel);
             }
             // ch_peaks[channel] = 0; // Clear peak
             active_midi_note = 0;
@@ -427,17 +580,13 @@ void player_tick(void) {
         if (is_shift_down()) {
             // Shift-F7: Decrease BPM
             if (seq.bpm > 60) {
-                seq.bpm--;
-                seq.ticks_per_row_fp = bpm_to_ticks_fp(seq.bpm);
-                update_dashboard();
+                engine_post(ENGINE_CMD_TEMPO, seq.bpm - 1);
                 // draw_status_message("Tempo Changed");
             }
         } else {
             // F7: Increase BPM
             if (seq.bpm < 240) {
-                seq.bpm++;
-                seq.ticks_per_row_fp = bpm_to_ticks_fp(seq.bpm);
-                update_dashboard();
+                engine_post(ENGINE_CMD_TEMPO, seq.bpm + 1);
                 // draw_status_message("Tempo Changed");
             }
         }
@@ -448,7 +597,7 @@ void player_tick(void) {
         read_cell(cur_pattern, cur_row, cur_channel, &cell);
         if (cell.note != 0) {
             current_instrument = cell.inst;
-            OPL_SetPatch(cur_channel, &gm_bank[current_instrument]);
+            preview_patch(cur_channel, current_instrument);
             update_dashboard();
         }
     }
@@ -483,9 +632,7 @@ void player_tick(void) {
     if (key_pressed(KEY_SLASH)) {
         effect_view_mode = !effect_view_mode;
         draw_headers(); // Update RN | NOTE EFFT label
-        render_grid();  // Swap columns on screen
-        update_cursor_visuals(cur_row, cur_row, cur_channel, cur_channel);
-        mark_playhead(play_row);
+        render_grid_deferred(); // Swap columns on screen
     }
 
     handle_song_order_input();
@@ -555,8 +702,75 @@ void handle_navigation() {
 
 }
 
+// Strike one non-empty cell: effect parse against the channel's shadow,
+// then the note. Shared by the music sequencer and the SFX players.
+void sequencer_play_cell(uint8_t ch, const PatternCell *cell) {
+    // Set when the effect handler already struck the note (Fine Pitch)
+    bool fine_pitch_triggered = false;
+
+    // --- 1. IDEMPOTENT EFFECT PARSING ---
+    // Dispatch on the command nibble; see effect_parse_table in effects.c
+    if (cell->effect != last_effect[ch]) {
+        fine_pitch_triggered = effect_parse_table[cell->effect >> 12](ch, cell);
+        last_effect[ch] = cell->effect; // Update shadow
+        if (cell->effect) effect_shadow_mask |= (1u << ch);
+        else effect_shadow_mask &= ~(1u << ch);
+    }
+
+    // --- 2. TRIGGER NOTE WITH OFFSET ---
+    if (cell->note != 0 && !fine_pitch_triggered) {
+        // Deactivate effects when new note + no effect command (cmd=0)
+        // This handles the case where effect column is 0000 but last_effect was also 0000
+        // (so effect parsing block was skipped)
+        uint8_t cmd = (cell->effect >> 12) & 0x0F;
+        if (cmd == 0 && cell->note != 255) {
+            ch_fx[ch] &= ~(FX_TREMOLO | FX_RETRIGGER | FX_VIBRATO | FX_GEN);
+        }
+        
+        OPL_NoteOff(ch); 
+        if (cell->note != 255) {
+            ch_arp.base_note[ch] = cell->note;
+            ch_arp.inst[ch] = cell->inst;
+            ch_arp.vol[ch]  = cell->vol;
+            
+            // Initialize portamento state
+            ch_porta.current_note[ch] = cell->note;
+            ch_porta.inst[ch] = cell->inst;
+            ch_porta.vol[ch] = cell->vol;
+            
+            // If we just triggered a new note, we reset the phase 
+            // so the melody remains predictable/on-beat.
+            FX_SET16(ch_arp.timer, ch, 0);
+            ch_arp.step_index[ch] = 0;
+            ch_arp.just_triggered[ch] = true; // DO NOT strike mid-row logic this frame
+
+            // If the generator is active, update its memory with the new note/inst/vol
+            if (ch_fx[ch] & FX_GEN) {
+                ch_generator.base_note[ch] = cell->note;
+                ch_generator.inst[ch] = cell->inst;
+                ch_generator.vol[ch]  = cell->vol;
+                FX_SET16(ch_generator.timer, ch, 0); // Reset timer on new note strike
+                ch_generator.just_triggered[ch] = true; // Match arp timing
+            }
+
+            // Calculate starting offset (Style 1 "Down" starts high!)
+            uint8_t start_offset = 0;
+            if (ch_fx[ch] & FX_ARP) {
+                start_offset = arp_offset(ch); // Cursor is back on step 0
+            }
+
+            OPL_SetPatch(ch, &gm_bank[cell->inst]);
+            volume_set(ch, cell->vol);
+            pitch_strike(ch, cell->note + start_offset, 0);
+        }
+    }
+}
+
 void sequencer_step(void) {
     if (!seq.is_playing) return;
+
+    uint16_t prof_start = engine_prof_now();
+    uint8_t prof_slot = PROF_IDLE;
     
     // Increment by 1.0 tick in 8.8 fixed-point (256 = 1.0)
     seq.tick_counter_fp += TICK_SCALE;
@@ -567,353 +781,53 @@ void sequencer_step(void) {
         seq.tick_counter_fp -= seq.ticks_per_row_fp;
 
 
-        for (uint8_t ch = 0; ch < 9; ch++) {
-            if (ch == cur_channel && active_midi_note != 0) continue;
-
-            PatternCell cell;
-            read_cell(cur_pattern, play_row, ch, &cell);
-
-            // Reset just_triggered flags for effects that need it
-            bool fine_pitch_triggered = false;
-            
-            // --- 1. IDEMPOTENT EFFECT PARSING ---
-            if (cell.effect != last_effect[ch]) {
-                uint16_t eff = cell.effect;
-                uint8_t cmd = (eff >> 12) & 0x0F;
-
-                if (cmd == 1) { 
-                    ch_arp[ch].active = true;
-                    ch_arp[ch].style  = (eff >> 8) & 0x0F;
-                    ch_arp[ch].depth  = (eff >> 4) & 0x0F;
-                    ch_arp[ch].speed_idx = (eff & 0x0F);
-                    
-                    // --- SCALE ARP TO TEMPO ---
-                    // base_frames is frames @ 150BPM (6 frames per row)
-                    uint16_t base_frames = arp_tick_lut[ch_arp[ch].speed_idx];
-                    
-                    // We calculate the target in fixed point:
-                    // target = base_frames * (current_row_duration / 6)
-                    // (seq.ticks_per_row_fp / 6) is the duration of one "step" in the current tempo
-                    ch_arp[ch].target_ticks_fp = (uint16_t)(((uint32_t)base_frames * seq.ticks_per_row_fp) / 6);
-
-                    ch_arp[ch].phase_timer_fp = 0;
-                    ch_arp[ch].step_index = 0;
-                    ch_arp[ch].just_triggered = true; // Prevent double-trigger on same row
-                } else if (cmd == 2) {
-                    // Portamento: 2SDT
-                    uint8_t mode = (eff >> 8) & 0x0F;
-                    uint8_t speed = (eff >> 4) & 0x0F;
-                    uint8_t t_val = (eff & 0x0F);
-
-                    // Starting Note: If there's a new note on this row, start from it.
-                    // Otherwise, start from whatever the channel was last playing.
-                    uint8_t start_note = (cell.note != 0 && cell.note != 255) ? cell.note : ch_arp[ch].base_note;
-                    
-                    ch_porta[ch].active = true;
-                    ch_porta[ch].current_note = start_note;
-                    ch_porta[ch].mode = mode;
-                    ch_porta[ch].speed = (speed == 0) ? 1 : speed;
-                    ch_porta[ch].tick_counter = 0;
-                    ch_porta[ch].vol = (cell.note != 0) ? cell.vol : ch_arp[ch].vol;
-                    ch_porta[ch].inst = (cell.note != 0) ? cell.inst : ch_arp[ch].inst;
-
-                    // Calculate Target
-                    switch (mode) {
-                        case 0: ch_porta[ch].target_note = 127; break; // Continuous Up
-                        case 1: ch_porta[ch].target_note = 0;   break; // Continuous Down
-                        case 2: // Up Relative
-                            {
-                                uint16_t t = (uint16_t)start_note + (t_val == 0 ? 12 : t_val);
-                                ch_porta[ch].target_note = (t > 127) ? 127 : (uint8_t)t;
-                            }
-                            break;
-                        case 3: // Down Relative
-                            {
-                                int16_t t = (int16_t)start_note - (t_val == 0 ? 12 : t_val);
-                                ch_porta[ch].target_note = (t < 0) ? 0 : (uint8_t)t;
-                            }
-                            break;
-                    }
-                    
-                    // Kill Arp so they don't fight over the pitch
-                    ch_arp[ch].active = false; 
-                } else if (cmd == 3) {
-                    // Volume Slide: 3SDT
-                    // S = Mode (0=Up, 1=Down, 2=To Target)
-                    // D = Speed (volume units per tick)
-                    // T = Target volume (0-F represents 0-63 scaled)
-                    
-                    uint16_t eff = cell.effect;
-                    uint8_t s_nibble = (eff >> 8) & 0x0F; // Mode
-                    uint8_t d_nibble = (eff >> 4) & 0x0F; // Speed (1-F)
-                    uint8_t t_nibble = (eff & 0x0F);      // Target (0-F)
-
-                    ch_volslide[ch].active = true;
-                    ch_volslide[ch].mode = s_nibble;
-
-                    // 1. Start from current row's volume (0-63)
-                    ch_volslide[ch].vol_accum = (uint16_t)cell.vol << 8;
-
-                    // 2. Scale 0-F target to 0-63
-                    ch_volslide[ch].target_vol = (t_nibble * 63) / 15;
-
-                    // 3. Set Speed: 84 is the "Magic Number" for ~32 rows at Speed 1
-                    if (d_nibble == 0) d_nibble = 1;
-                    ch_volslide[ch].speed_fp = (uint16_t)d_nibble * 84U;
-
-                    // 4. Default targets for Mode 0 (Up) and 1 (Down) if T is 0
-                    if (s_nibble == 0 && t_nibble == 0) ch_volslide[ch].target_vol = 63;
-                    if (s_nibble == 1 && t_nibble == 0) ch_volslide[ch].target_vol = 0;
-                } else if (cmd == 4) {
-                    // Vibrato: 4RDT
-                    // R = Rate (ticks per phase step - lower = faster)
-                    // D = Depth (pitch deviation in semitones)
-                    // T = Waveform (0=sine, 1=triangle, 2=square)
-                    
-                    // Determine starting note and volume
-                    uint8_t start_note = (cell.note != 0 && cell.note != 255) ? cell.note : ch_arp[ch].base_note;
-                    uint8_t start_inst = (cell.note != 0 && cell.note != 255) ? cell.inst : ch_arp[ch].inst;
-                    uint8_t start_vol = (cell.note != 0 && cell.note != 255) ? cell.vol : ch_arp[ch].vol;
-                    
-                    ch_vibrato[ch].base_note = start_note;
-                    ch_vibrato[ch].inst = start_inst;
-                    ch_vibrato[ch].vol = start_vol;
-                    
-                    ch_vibrato[ch].active = true;
-                    ch_vibrato[ch].rate = (eff >> 8) & 0x0F;
-                    if (ch_vibrato[ch].rate == 0) ch_vibrato[ch].rate = 4; // Default rate
-                    ch_vibrato[ch].depth = (eff >> 4) & 0x0F;
-                    if (ch_vibrato[ch].depth == 0) ch_vibrato[ch].depth = 2; // Default depth
-                    ch_vibrato[ch].waveform = (eff & 0x0F) % 3; // 0-2 only
-                    ch_vibrato[ch].phase = 0;
-                    ch_vibrato[ch].tick_counter = 0;
-                    
-                    ch_arp[ch].active = false; // Vibrato kills arpeggio
-                } else if (cmd == 5) {
-                    // Note Cut: 5__T
-                    // T = Ticks before cut (0-F maps to 0-15 ticks)
-                    uint8_t base_cut_ticks = (eff & 0x0F);
-                    if (base_cut_ticks == 0) base_cut_ticks = 1;
-
-                    // Scale: (base * ticks_per_row_fp) / 1536
-                    uint32_t scaled = ((uint32_t)base_cut_ticks * seq.ticks_per_row_fp) / 1536;
-                    ch_notecut[ch].cut_tick = (uint8_t)scaled;
-                    if (ch_notecut[ch].cut_tick == 0) ch_notecut[ch].cut_tick = 1;
-
-                    ch_notecut[ch].active = true;
-                    ch_notecut[ch].tick_counter = 0;
-                } else if (cmd == 6) {
-                    // Automatic Echo: 6VDT
-                    uint8_t echo_vol_nibble = (eff >> 8) & 0x0F;
-                    uint8_t delay_nibble     = (eff >> 4) & 0x0F;
-                    uint8_t transposition   = (eff & 0x0F);
-                    
-                    uint8_t base = (cell.note != 0 && cell.note != 255) ? cell.note : ch_arp[ch].base_note;
-
-                    ch_notedelay[ch].active = true;
-                    ch_notedelay[ch].timer_fp = 0;
-                    
-                    // --- THE TEMPO SCALE FIX ---
-                    // One logical "tick" duration in the current tempo is (ticks_per_row_fp / 6)
-                    if (delay_nibble == 0) delay_nibble = 3; // Default to half row
-                    uint32_t one_tick_duration = seq.ticks_per_row_fp / 6;
-                    ch_notedelay[ch].target_fp = (uint16_t)(one_tick_duration * delay_nibble);
-                    
-                    // Set note, inst, and starting volume
-                    ch_notedelay[ch].note = base + transposition;
-                    if (ch_notedelay[ch].note > 127) ch_notedelay[ch].note = 127;
-                    ch_notedelay[ch].vol = (echo_vol_nibble * 63) / 15;
-                    ch_notedelay[ch].inst = (cell.note != 0) ? cell.inst : ch_arp[ch].inst;
-
-                    // Note: We do NOT set skip_note_trigger. 
-                    // The note in cell.note will play normally on Tick 0.
-                } else if (cmd == 7) {
-                    // Retrigger: 7__T
-                    uint8_t speed = (eff & 0x0F);
-                    if (speed == 0) speed = 3; // Default
-                    
-                    uint8_t note = (cell.note != 0 && cell.note != 255) ? cell.note : ch_arp[ch].base_note;
-                    
-                    ch_retrigger[ch].active = true;
-                    ch_retrigger[ch].speed = speed;
-                    ch_retrigger[ch].note = note;
-                    ch_retrigger[ch].inst = (cell.note != 0 && cell.note != 255) ? cell.inst : ch_arp[ch].inst;
-                    ch_retrigger[ch].vol  = (cell.note != 0 && cell.note != 255) ? cell.vol : ch_arp[ch].vol;
-                    
-                    // --- THE FIX: SCALE TO TEMPO ---
-                    // At 150 BPM, one musical tick = 256 (TICK_SCALE).
-                    // Formula: (Current Row Duration in FP / 6) * speed
-                    uint32_t one_tick_fp = (seq.ticks_per_row_fp / 6);
-                    ch_retrigger[ch].target_fp = (uint16_t)(one_tick_fp * speed);
-                    
-                    ch_retrigger[ch].timer_fp = 0;
-                    ch_retrigger[ch].just_triggered = true; // Sync with sequencer strike
-                } else if (cmd == 8) {
-                    // Tremolo: 8RDT
-                    uint8_t rate = (eff >> 8) & 0x0F;
-                    uint8_t depth = (eff >> 4) & 0x0F;
-                    uint8_t wave = (eff & 0x0F);
-
-                    // Sync base state
-                    ch_tremolo[ch].active = true;
-                    ch_tremolo[ch].rate = rate;
-                    ch_tremolo[ch].depth = depth;
-                    ch_tremolo[ch].waveform = wave;
-                    
-                    // Anchor the oscillation to the volume on this row
-                    ch_tremolo[ch].base_vol = (cell.note != 0) ? cell.vol : ch_volslide[ch].current_vol;
-                    
-                    // Optional: Reset phase on new note to make the pulse predictable
-                    if (cell.note != 0) {
-                        ch_tremolo[ch].phase = 0;
-                    }
-                } else if (cmd == 9) {
-                    // Fine Pitch: 9_DD (8-bit signed)
-                    // Interprets the lower 8 bits as a signed value (-128 to 127)
-                    // representing steps of 1/32 semitone.
-                    int8_t detune = (int8_t)(eff & 0xFF);
-                    
-                    // Deciding the note to play:
-                    uint8_t note = (cell.note != 0 && cell.note != 255) ? cell.note : ch_arp[ch].base_note;
-                    
-                    ch_finepitch[ch].active = true;
-                    ch_finepitch[ch].base_note = note;
-                    ch_finepitch[ch].detune = detune;
-                    ch_finepitch[ch].inst = (cell.note != 0 && cell.note != 255) ? cell.inst : ch_arp[ch].inst;
-                    ch_finepitch[ch].vol = (cell.note != 0 && cell.note != 255) ? cell.vol : ch_arp[ch].vol;
-                    
-                    // Strike the detuned note now
-                    OPL_NoteOff(ch);
-                    OPL_SetPatch(ch, &gm_bank[ch_finepitch[ch].inst]);
-                    OPL_SetVolume(ch, ch_finepitch[ch].vol << 1); 
-                    
-                    // CALL THE DETUNED FUNCTION
-                    OPL_NoteOn_Detuned(ch, note, detune);
-                    
-                    ch_peaks[ch] = ch_finepitch[ch].vol;
-
-                    // --- THE FIX: Mark this as handled! ---
-                    fine_pitch_triggered = true; 
-                } else if (cmd == 0x0A) { // Random Generator: A S D T
-                    ch_generator[ch].active = true;
-                    ch_generator[ch].scale  = (eff >> 8) & 0x0F;
-                    ch_generator[ch].range  = (eff >> 4) & 0x0F;
-                    
-                    // Scale generator timing with tempo (same as arpeggio)
-                    uint16_t base_frames = arp_tick_lut[eff & 0x0F];
-                    uint32_t scaled = ((uint32_t)base_frames * seq.ticks_per_row_fp) / 1536;
-                    ch_generator[ch].target_ticks = (uint8_t)scaled;
-                    if (ch_generator[ch].target_ticks == 0) ch_generator[ch].target_ticks = 1;
-                    
-                    ch_generator[ch].timer = 0;
-                    ch_generator[ch].just_triggered = true;
-
-                    // --- THE FIX: CAPTURE CONTEXT ---
-                    // If there is a note on this row, use it. 
-                    // Otherwise, fall back to the last known state for this channel.
-                    if (cell.note != 0 && cell.note != 255) {
-                        ch_generator[ch].base_note = cell.note;
-                        ch_generator[ch].inst = cell.inst;
-                        ch_generator[ch].vol  = cell.vol;
-                    } else {
-                        // Fallback to Arp memory if no note on this row
-                        ch_generator[ch].base_note = ch_arp[ch].base_note;
-                        ch_generator[ch].inst = ch_arp[ch].inst;
-                        ch_generator[ch].vol  = ch_arp[ch].vol;
-                    }
-                } else if (eff == 0xF000 || (cell.note != 0 && cmd == 0)) {
-                    if (ch_tremolo[ch].active) {
-                        ch_tremolo[ch].active = false;
-                        OPL_SetVolume(ch, ch_tremolo[ch].base_vol << 1); // Restore original volume
-                    }
-                    ch_arp[ch].active = false;
-                    ch_porta[ch].active = false;
-                    ch_volslide[ch].active = false;
-                    ch_notecut[ch].active = false;
-                    ch_notedelay[ch].active = false;
-                    ch_retrigger[ch].active = false;
-                    ch_tremolo[ch].active = false;
-                    ch_finepitch[ch].active = false;
-                    
-                    // Deactivate vibrato - don't reset pitch here because
-                    // a new note trigger will follow and set its own pitch
-                    ch_vibrato[ch].active = false;
-
-                    ch_generator[ch].active = false;
+        // Only the row's non-empty cells, from the compiled pattern stream
+        const PatternStream *st = stream_get(cur_pattern, play_row);
+        uint16_t skip = (active_midi_note != 0) ? (1u << cur_channel) : 0;
+        skip |= (~channel_mask | sfx_held) & CHANNEL_MASK_ALL;
 
-                }
-                // Note: Removed the "else if (cmd == 0 && eff == 0x0000)" handler
-                // Empty rows should NOT reset vibrato pitch - let it oscillate freely
-                last_effect[ch] = cell.effect; // Update shadow
+        // Empty cells on channels with a live effect shadow: clearing the
+        // shadow is all the old per-cell parse did for them
+        uint16_t stale = effect_shadow_mask & ~st->mask[play_row] & ~skip;
+        if (stale) {
+            effect_shadow_mask &= ~stale;
+            for (uint8_t ch = 0; stale; ch++, stale >>= 1) {
+                if (stale & 1) last_effect[ch] = 0;
             }
+        }
 
-            // --- 2. TRIGGER NOTE WITH OFFSET ---
-            if (cell.note != 0 && !fine_pitch_triggered) {
-                // Deactivate effects when new note + no effect command (cmd=0)
-                // This handles the case where effect column is 0000 but last_effect was also 0000
-                // (so effect parsing block was skipped)
-                uint8_t cmd = (cell.effect >> 12) & 0x0F;
-                if (cmd == 0 && cell.note != 255) {
-                    ch_tremolo[ch].active = false;
-                    ch_retrigger[ch].active = false;
-                    ch_vibrato[ch].active = false;
-                    ch_generator[ch].active = false;
-                }
-                
-                OPL_NoteOff(ch); 
-                if (cell.note != 255) {
-                    ch_arp[ch].base_note = cell.note;
-                    ch_arp[ch].inst = cell.inst;
-                    ch_arp[ch].vol  = cell.vol;
-                    
-                    // Initialize portamento state
-                    ch_porta[ch].current_note = cell.note;
-                    ch_porta[ch].inst = cell.inst;
-                    ch_porta[ch].vol = cell.vol;
-                    
-                    // If we just triggered a new note, we reset the phase 
-                    // so the melody remains predictable/on-beat.
-                    ch_arp[ch].phase_timer_fp = 0;
-                    ch_arp[ch].step_index = 0;
-                    ch_arp[ch].just_triggered = true; // DO NOT strike mid-row logic this frame
-
-                    // If the generator is active, update its memory with the new note/inst/vol
-                    if (ch_generator[ch].active) {
-                        ch_generator[ch].base_note = cell.note;
-                        ch_generator[ch].inst = cell.inst;
-                        ch_generator[ch].vol  = cell.vol;
-                        ch_generator[ch].timer = 0; // Reset timer on new note strike
-                        ch_generator[ch].just_triggered = true; // Match arp timing
-                    }
+        fx_row_start |= ~sfx_held & CHANNEL_MASK_ALL;
 
-                    // Calculate starting offset (Style 1 "Down" starts high!)
-                    int16_t start_offset = 0;
-                    if (ch_arp[ch].active) {
-                        start_offset = get_arp_offset(ch_arp[ch].style, ch_arp[ch].depth, 0);
-                    }
+        const PatternEvent *ev = st->ev[play_row];
+        for (uint8_t n = st->count[play_row]; n; n--, ev++) {
+            uint8_t ch = ev->ch;
+            if (skip & (1u << ch)) continue;
 
-                    OPL_SetPatch(ch, &gm_bank[cell.inst]);
-                    OPL_SetVolume(ch, cell.vol << 1); 
-                    OPL_NoteOn(ch, cell.note + start_offset);
-                    ch_peaks[ch] = cell.vol;
-                }
-            }
+            sequencer_play_cell(ch, &ev->cell);
         }
 
-        // Handle Follow Mode (Sync cursor to the note just struck)
-        if (is_follow_mode) {
-            uint8_t old_edit_row = cur_row;
-            cur_row = play_row;
-            if (cur_row != old_edit_row) {
-                update_cursor_visuals(old_edit_row, cur_row, cur_channel, cur_channel);
-            }
+        // Follow mode is drawn by the UI, see sequencer_sync_ui()
+        engine_post_event(ENGINE_EV_ROW);
+        prof_slot = PROF_ROW;
+    } else {
+        // Idle frame: fetch and compile the next row now, so the row frame
+        // is left with just the effect parse and the OPL writes
+        if (play_row < 31 || !is_song_mode) {
+            stream_lookahead(cur_pattern, (play_row + 1) & 31);
         }
 
-
+        // Near the end of the pattern: compile the next one ahead
+        if (is_song_mode && play_row >= STREAM_PREFETCH_ROW) {
+            uint8_t next_idx = cur_order_idx + 1;
+            if (next_idx >= song_length) next_idx = 0;
+            stream_prefetch(read_order_xram(next_idx));
+        }
     }
 
     // --- PHASE B: PER-VSYNC TICK ---
-    process_per_frame_effects();
+    uint16_t prof_fx = engine_prof_now();
+    sequencer_run_effects(channel_mask);
+    engine_prof_end(PROF_EFFECTS, prof_fx);
 
     // If we just finished the last tick of the row
     // Check if tick_counter_fp is >= (ticks_per_row_fp - TICK_SCALE)
@@ -927,12 +841,126 @@ void sequencer_step(void) {
                 cur_order_idx++;
                 if (cur_order_idx >= song_length) cur_order_idx = 0;
                 cur_pattern = read_order_xram(cur_order_idx);
-                render_grid();
-                update_dashboard();
+                engine_post_event(ENGINE_EV_ORDER);
             }
         }
     }
 
+    engine_prof_end(prof_slot, prof_start);
+}
+
+// Engine side of the transport, run from the IRQ via ENGINE_CMD_*
+
+void sequencer_play(void) {
+    // First sequencer_step() processes the current row immediately
+    seq.tick_counter_fp = seq.ticks_per_row_fp;
+    seq.is_playing = true;
+}
+
+void sequencer_pause(void) {
+    seq.is_playing = false;
+}
+
+// Stop, silence and rewind to the beginning
+void sequencer_stop(void) {
+    seq.is_playing = false;
+
+    // Silence all channels
+    for (uint8_t i = 0; i < 9; i++) {
+        OPL_NoteOff(i);
+        // ch_peaks[i] = 0; // Clear peak
+    }
+
+    reset_effect_shadow();
+    for (int i=0; i<9; i++) {
+        ch_fx[i] &= FX_GEN; // Everything but the generator
+    }
+
+    seq.tick_counter_fp = 0;
+    play_row = 0;
+    cur_order_idx = 0;
+}
+
+// Chase-seek: play from the top up to (order, row) with the chip muted,
+// so patches, pitches and running effects are what they would have been
+// had it played through, then send the chip only what changed. Playback
+// carries on from the target row. In pattern mode only the row counts.
+// Foreground only, with the engine held.
+void sequencer_seek(uint8_t order, uint8_t row) {
+    if (order >= song_length) order = song_length ? song_length - 1 : 0;
+    row &= 31;
+
+    // Key off for real; the sync re-keys whatever sounds at the target
+    for (uint8_t i = 0; i < 9; i++) {
+        OPL_NoteOff(i);
+    }
+    OPL_ShadowSnapshot();
+
+    // Pattern mode plays cur_pattern; the order cursor stays where it is
+    uint8_t keep_order = cur_order_idx;
+    sequencer_rewind();
+    if (!is_song_mode) cur_order_idx = keep_order;
+    opl_silent = true;
+    while (play_row != row || (is_song_mode && cur_order_idx != order)) {
+        sequencer_step();
+    }
+    opl_silent = false;
+
+    OPL_ShadowSync();
+}
+
+// Mute/solo. Channels going off are keyed off with their effects killed;
+// channels coming back re-parse their next effect cell.
+void sequencer_set_channels(uint16_t mask) {
+    mask &= CHANNEL_MASK_ALL;
+    uint16_t off = channel_mask & ~mask;
+    uint16_t on = mask & ~channel_mask;
+    channel_mask = mask;
+
+    for (uint8_t ch = 0; ch < 9; ch++, off >>= 1, on >>= 1) {
+        if (off & 1) {
+            effects_reset_channel(ch);
+            OPL_NoteOff(ch);
+            ch_peaks[ch] = 0;
+        }
+        if (on & 1) sequencer_rejoin_channel(ch);
+    }
+}
+
+// A channel handed back (unmute, SFX release) re-parses its next effect
+void sequencer_rejoin_channel(uint8_t ch) {
+    last_effect[ch] = 0xFFFF;
+    effect_shadow_mask |= (1u << ch);
+}
+
+// An empty cell only retires the channel's effect shadow
+void sequencer_empty_cell(uint8_t ch) {
+    last_effect[ch] = 0;
+    effect_shadow_mask &= ~(1u << ch);
+}
+
+// UI side of the sequencer: redraw whatever the engine moved since the
+// last frame. Call once per main loop pass.
+void sequencer_sync_ui(void) {
+    static uint16_t seen_missed;
+    if (engine_missed_frames != seen_missed) {
+        seen_missed = engine_missed_frames;
+        draw_missed_frames();
+    }
+
+    uint8_t ev = engine_take_events();
+    if (!ev) return;
+
+    if (ev & ENGINE_EV_ORDER) render_grid_deferred();
+    if (ev & (ENGINE_EV_ORDER | ENGINE_EV_STATE)) update_dashboard();
+    if ((ev & ENGINE_EV_STATE) && !seq.is_playing) engine_prof_report();
+
+    // Follow Mode: sync the cursor to the row just struck. The main
+    // loop sees cur_row move and redraws the cursor.
+    if (ev & ENGINE_EV_ROW) {
+        if (is_follow_mode) cur_row = play_row;
+        draw_song_time(false);
+    }
 }
 
 void handle_transport_controls() {
@@ -943,57 +971,49 @@ void handle_transport_controls() {
         // Shift + Enter : Stop & Reset to Beginning
         if (is_shift_down()) {
 
-            seq.is_playing = false;
-            
-            // Silence all channels
-            for (uint8_t i = 0; i < 9; i++) {
-                OPL_NoteOff(i);
-                // ch_peaks[i] = 0; // Clear peak
-            }
-            
-            for (int i=0; i<9; i++) {
-                last_effect[i] = 0xFFFF;
-                ch_arp[i].active = false;
-                ch_porta[i].active = false;
-                ch_volslide[i].active = false;
-                ch_vibrato[i].active = false;
-                ch_notecut[i].active = false;
-                ch_notedelay[i].active = false;
-                ch_retrigger[i].active = false;
-                ch_tremolo[i].active = false;
-                ch_finepitch[i].active = false;
-            }
+            // The engine silences, resets effects and rewinds
+            engine_post(ENGINE_CMD_STOP, 0);
 
-            // Reset to beginning
+            // Reset the cursor to the beginning
             uint8_t old = cur_row;
             cur_row = 0;
-            seq.tick_counter_fp = 0;
-            play_row = 0;
-            cur_order_idx = 0;
             
             update_cursor_visuals(old, 0, cur_channel, cur_channel);
-            mark_playhead(play_row);
-            update_dashboard();
+            mark_playhead(0);
             
         }
+        // Alt + Enter : Audition the pattern on screen as a sound effect
+        else if (is_alt_down()) {
+            sfx_play(cur_pattern, 1);
+        }
+        // Ctrl + Enter : Chase to the cursor and play from there
+        else if (is_ctrl_down()) {
+            engine_hold = true;
+            engine_headless = true;
+            sequencer_seek(cur_order_idx, cur_row);
+            engine_headless = false;
+            engine_hold = false;
+
+            render_grid_deferred();
+            update_dashboard();
+        }
         // Enter : Play / Pause Toggle
         else {
 
-            seq.is_playing = !seq.is_playing;
-            
-            if (seq.is_playing) {
-                seq.tick_counter_fp = seq.ticks_per_row_fp; 
-
+            if (!seq.is_playing) {
                 // --- THE FIX ---
                 if (is_song_mode) {
                     // Sync to the song structure only if we are in SONG mode
                     cur_pattern = read_order_xram(cur_order_idx);
-                    render_grid(); 
+                    render_grid_deferred(); 
                 } 
                 // If is_song_mode is false, we don't touch cur_pattern.
                 // It stays on the pattern you were manually editing.
+                engine_post(ENGINE_CMD_PLAY, 0);
+            } else {
+                engine_post(ENGINE_CMD_PAUSE, 0);
             }
-            update_dashboard();
+            // Dashboard redraws once the engine has switched state
         }
     }
 
@@ -1108,7 +1128,9 @@ void modify_volume_effects(int8_t delta) {
             write_cell(cur_pattern, cur_row, cur_channel, &cell);
             render_row(cur_row);
             mark_playhead(play_row);
+            engine_irq_off();
             OPL_SetVolume(cur_channel, cell.vol << 1);
+            engine_irq_restore();
         } 
         else {
             int16_t v = (int16_t)current_volume + delta;
@@ -1156,7 +1178,7 @@ void modify_instrument(int8_t delta) {
     if (effect_view_mode) {
         effect_view_mode = false;
         draw_headers();
-        render_grid();
+        render_grid_deferred();
     }
     
     if (is_shift_down()) {
@@ -1171,7 +1193,7 @@ void modify_instrument(int8_t delta) {
         render_row(cur_row);
         
         // Live Preview: Update OPL2 patch immediately
-        OPL_SetPatch(cur_channel, &gm_bank[cell.inst]);
+        preview_patch(cur_channel, cell.inst);
     } 
     else {
         // --- GLOBAL BRUSH EDIT ONLY ---
@@ -1198,9 +1220,9 @@ void modify_note(int8_t delta) {
         
         int16_t new_note = (int16_t)cell.note + amount;
         
-        // Clamp to MIDI/OPL2 range (C-0 to B-8)
+        // Clamp to what the OPL2 can play (C-0 up to opl_note_max)
         if (new_note < 12)  new_note = 12;
-        if (new_note > 119) new_note = 119;
+        if (new_note > opl_note_max) new_note = opl_note_max;
         
         cell.note = (uint8_t)new_note;
         
@@ -1211,11 +1233,7 @@ void modify_note(int8_t delta) {
         render_row(cur_row); 
         
         // 3. Live Preview: Play the "nudged" note
-        OPL_NoteOff(cur_channel);
-        // ch_peaks[cur_channel] = 0; // Clear peak
-        OPL_SetPatch(cur_channel, &gm_bank[cell.inst]);
-        OPL_SetVolume(cur_channel, cell.vol << 1);
-        OPL_NoteOn(cur_channel, cell.note);
+        preview_note(cur_channel, cell.inst, cell.vol, cell.note);
         ch_peaks[cur_channel] = cell.vol; // Set peak
     }
 }
@@ -1232,13 +1250,9 @@ void change_pattern(int8_t delta) {
 
     // 2. If the pattern actually changed, refresh the whole screen
     if (cur_pattern != old_pat) {
-        render_grid(); // Redraw all 32 rows for the new pattern
+        render_grid_deferred(); // Redraw all 32 rows for the new pattern
         update_dashboard(); // Update the "PAT: XX" display
         
-        // Ensure the cursor highlight is still drawn on the current row
-        update_cursor_visuals(cur_row, cur_row, cur_channel, cur_channel);
-        mark_playhead(play_row);
-        
         printf("Switched to Pattern: %02X\n", cur_pattern);
     }
 }
@@ -1261,7 +1275,7 @@ void handle_song_order_input() {
             write_order_xram(cur_order_idx, p);
             // SYNC: Immediately update the current editing pattern to match
             cur_pattern = p; 
-            render_grid();
+            render_grid_deferred();
         }
     }
     
@@ -1288,7 +1302,7 @@ void handle_song_order_input() {
         if (state_changed) {
             // SYNC: Ensure pattern matches the (potentially snapped) index
             cur_pattern = read_order_xram(cur_order_idx);
-            render_grid();
+            render_grid_deferred();
         }
     }
     
@@ -1309,7 +1323,7 @@ void handle_song_order_input() {
             // CONSISTENCY: Always update cur_pattern when navigating sequence.
             // This removes the "confusing view" by ensuring the grid follows the sequence highlight.
             cur_pattern = read_order_xram(cur_order_idx);
-            render_grid();
+            render_grid_deferred();
         }
     }
 
@@ -1345,12 +1359,11 @@ void pattern_paste(uint8_t pat_idx) {
     for (uint16_t i = 0; i < PATTERN_SIZE; i++) {
         RIA.rw0 = pattern_clipboard[i];
     }
+    stream_invalidate(pat_idx);
     
     // Force the current view to sync if we pasted into the active pattern
     if (pat_idx == cur_pattern) {
-        render_grid();
-        update_cursor_visuals(cur_row, cur_row, cur_channel, cur_channel);
-        mark_playhead(play_row);
+        render_grid_deferred();
     }
     printf("Pattern %02X Pasted.\n", pat_idx);
 }
@@ -3,9 +3,12 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "screen.h"
 
 // Buffer to hold one full pattern (32 rows * 9 channels * 5 bytes)
 #define PATTERN_SIZE 1440U 
+#define ROW_SIZE     45U   // 9 channels * 5 bytes
+#define CELL_SIZE    5U
 
 #define is_shift_down() (key(KEY_LEFTSHIFT) || key(KEY_RIGHTSHIFT))
 #define is_ctrl_down()  (key(KEY_LEFTCTRL)  || key(KEY_RIGHTCTRL))
@@ -24,6 +27,11 @@ typedef struct {
 extern SequencerState seq;
 
 extern bool is_follow_mode;
+
+// Enabled channels, bit per channel. Masked channels are skipped by the
+// sequencer, the effect engines and the meters. Written by the engine.
+#define CHANNEL_MASK_ALL 0x1FF
+extern uint16_t channel_mask;
 extern uint8_t play_row;
 
 // Initialize player state
@@ -32,6 +40,12 @@ void player_init(void);
 // Process keyboard-to-OPL logic (call this once per frame in main loop)
 void player_tick(void);
 
+// Load a patch on a channel from the UI, with the engine IRQ held off
+void preview_patch(uint8_t ch, uint8_t inst);
+
+// Export the song from the top to a .BIN named after it (Ctrl+E)
+void export_song(void);
+
 // Global settings
 extern uint8_t current_octave;
 extern uint8_t current_instrument;
@@ -44,6 +58,16 @@ extern uint16_t lfo_tempo_scaler;
 extern void handle_navigation(void);
 extern void handle_transport_controls(void);
 extern void sequencer_step(void);
+extern void sequencer_play(void);
+extern void sequencer_pause(void);
+extern void sequencer_stop(void);
+extern void sequencer_seek(uint8_t order, uint8_t row);
+extern void sequencer_set_channels(uint16_t mask);
+extern void sequencer_play_cell(uint8_t ch, const PatternCell *cell);
+extern void sequencer_rejoin_channel(uint8_t ch);
+extern void sequencer_empty_cell(uint8_t ch);
+extern void sequencer_run_effects(uint16_t mask);
+extern void sequencer_sync_ui(void);
 extern void handle_editing(void);
 extern void modify_volume_effects(int8_t delta);
 extern void modify_effect_low_byte(int8_t delta);
@@ -54,8 +78,17 @@ extern void handle_song_order_input(void);
 extern void pattern_copy(uint8_t pattern_id);
 extern void pattern_paste(uint8_t pattern_id);
 extern void update_lfo_scaler(void);
+extern uint16_t bpm_to_ticks_fp(uint8_t bpm);
+
+// Song timeline, in engine ticks (ENGINE_TICK_HZ per second)
+extern uint32_t song_row_ticks(uint16_t row_idx);
+extern uint32_t song_order_ticks(uint8_t order);
+extern uint32_t song_total_ticks(void);
+extern uint32_t song_elapsed_ticks(void);
+extern void reset_effect_shadow(void);
 
 extern uint16_t get_pattern_xram_addr(uint8_t pat, uint8_t row, uint8_t chan);
+extern uint16_t get_row_xram_addr(uint8_t pat, uint8_t row);
 extern uint8_t active_midi_note;
 
 #endif
\ No newline at end of file
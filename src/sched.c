@@ -0,0 +1,46 @@
+#include <rp6502.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sched.h"
+
+typedef struct {
+    SchedTask fn;
+    uint8_t level;
+} SchedEntry;
+
+// Kept sorted by level
+static SchedEntry tasks[SCHED_MAX_TASKS];
+static uint8_t task_count = 0;
+
+static uint8_t frame_vsync;
+
+bool sched_add(SchedTask fn, uint8_t level) {
+    if (task_count >= SCHED_MAX_TASKS) return false;
+
+    // Insert after every task of the same or a higher priority
+    uint8_t i = task_count;
+    while (i && tasks[i - 1].level > level) {
+        tasks[i] = tasks[i - 1];
+        i--;
+    }
+    tasks[i].fn = fn;
+    tasks[i].level = level;
+    task_count++;
+    return true;
+}
+
+bool sched_time_left(void) {
+    return RIA.vsync == frame_vsync;
+}
+
+void sched_run_frame(void) {
+    // An overrun frame has already seen the next vsync: start right away
+    while (RIA.vsync == frame_vsync);
+    frame_vsync = RIA.vsync;
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        // Sorted, so everything from here on is budgeted too
+        if (tasks[i].level >= SCHED_UI && !sched_time_left()) break;
+        tasks[i].fn();
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// MAIN LOOP SCHEDULER
+// ============================================================================
+// The foreground's work as tasks at four priority levels. A frame starts
+// on vsync and runs the tasks level by level. Audio and input tasks always
+// run; UI and background tasks only while the frame lasts, i.e. until
+// RIA.vsync moves. Under load background work starves first, then UI.
+// Long UI jobs do a slice per call, checking sched_time_left(), and pick
+// up where they were next frame.
+//
+// Playback itself runs in the engine IRQ. SCHED_AUDIO is for the
+// foreground's own sound path: keys, MIDI and panic.
+
+#define SCHED_AUDIO      0
+#define SCHED_INPUT      1
+#define SCHED_UI         2  // First budgeted level
+#define SCHED_BACKGROUND 3
+
+#define SCHED_MAX_TASKS  8
+
+typedef void (*SchedTask)(void);
+
+// Register a task. Tasks run in level order, then in order added.
+// Returns false if the table is full.
+extern bool sched_add(SchedTask fn, uint8_t level);
+
+// Wait for the next vsync (unless the last frame overran) and run a frame
+extern void sched_run_frame(void);
+
+// True while the current frame hasn't run out
+extern bool sched_time_left(void);
+
+#endif // SCHED_H
@@ -7,6 +7,9 @@
 #include "instruments.h"
 #include "player.h"
 #include "song.h"
+#include "stream.h"
+#include "engine.h"
+#include "sched.h"
 
 // Peak meter state (0-63)
 uint8_t ch_peaks[9] = {0,0,0,0,0,0,0,0,0};
@@ -34,6 +37,9 @@ void write_cell(uint8_t pat, uint8_t row, uint8_t chan, PatternCell *cell) {
     // We write Low Byte then High Byte (Standard 6502 Little-Endian)
     RIA.rw0 = (uint8_t)(cell->effect & 0x00FF);
     RIA.rw0 = (uint8_t)(cell->effect >> 8);
+
+    // Keep the sequencer's compiled copy of this pattern in sync
+    stream_invalidate_row(pat, row);
 }
 
 void read_cell(uint8_t pat, uint8_t row, uint8_t chan, PatternCell *cell) {
@@ -48,6 +54,21 @@ void read_cell(uint8_t pat, uint8_t row, uint8_t chan, PatternCell *cell) {
     cell->effect = (uint16_t)((hi << 8) | lo);
 }
 
+// Fetch all 9 cells of a row in one auto-incrementing burst.
+// The row is contiguous in XRAM, so the portal is only set up once.
+void read_row(uint8_t pat, uint8_t row, PatternCell *cells) {
+    RIA.addr0 = get_row_xram_addr(pat, row);
+    RIA.step0 = 1;
+    for (uint8_t ch = 0; ch < 9; ch++) {
+        cells[ch].note = RIA.rw0;
+        cells[ch].inst = RIA.rw0;
+        cells[ch].vol = RIA.rw0;
+        uint8_t lo = RIA.rw0;
+        uint8_t hi = RIA.rw0;
+        cells[ch].effect = (uint16_t)((hi << 8) | lo);
+    }
+}
+
 const char* const note_names[] = {
     "C-", "C#", "D-", "D#", "E-", "F-", "F#", "G-", "G#", "A-", "A#", "B-"
 };
@@ -141,9 +162,7 @@ void render_row(uint8_t row_idx) {
 
     // 1. BUFFER THE DATA: Read the row from XRAM into 6502 internal RAM
     // This prevents read_cell from clobbering RIA.addr0 during drawing.
-    for (uint8_t ch = 0; ch < 9; ch++) {
-        read_cell(cur_pattern, row_idx, ch, &row_data[ch]);
-    }
+    read_row(cur_pattern, row_idx, row_data);
 
     // 2. SETUP VGA DRAWING
     uint8_t screen_y = row_idx + GRID_SCREEN_OFFSET;
@@ -220,13 +239,34 @@ void render_row(uint8_t row_idx) {
     }
 }
 
+// Next row of a deferred grid redraw, 32 when there is none
+static uint8_t grid_next_row = 32;
+
 void render_grid(void) {
+    grid_next_row = 32; // Supersedes any deferred redraw
+
     // We are showing 32 rows (0x00 to 0x1F)
     for (uint8_t i = 0; i < 32; i++) {
         render_row(i); // 'i' becomes 'pattern_row_idx' inside the function
     }
 }
 
+void render_grid_deferred(void) {
+    grid_next_row = 0;
+}
+
+// Draw deferred rows while the frame lasts, at least one per call.
+// Returns true on the call that completes the grid.
+bool render_grid_step(void) {
+    if (grid_next_row >= 32) return false;
+
+    do {
+        render_row(grid_next_row++);
+    } while (grid_next_row < 32 && sched_time_left());
+
+    return grid_next_row >= 32;
+}
+
 void set_row_color(uint8_t row_idx, uint8_t bg_color) {
     // Point to the BG byte (3rd byte) of the first character in the row
     uint16_t addr = text_message_addr + ((row_idx + 2) * 80 * 3) + 2;
@@ -428,6 +468,8 @@ void draw_ui_dashboard(void) {
     
     // BPM Display (below INS:)
     draw_string(2, 9, "BPM:      TKS: 06", HUD_COL_CYAN, HUD_COL_BG);
+    draw_string(22, 9, "TIME:      /", HUD_COL_CYAN, HUD_COL_BG);
+    draw_string(41, 9, "LATE:", HUD_COL_CYAN, HUD_COL_BG);
 
     // 3. Operator Headers
     draw_string(2, 11, "[ MODULATOR / OP1 ]", HUD_COL_YELLOW, HUD_COL_BG);
@@ -486,6 +528,36 @@ void draw_ui_dashboard(void) {
     
 }
 
+// MM:SS from engine ticks
+static void draw_time(uint8_t x, uint8_t y, uint32_t ticks) {
+    uint16_t secs = (uint16_t)(ticks / ENGINE_TICK_HZ);
+    uint8_t mins = (secs / 60 > 99) ? 99 : (uint8_t)(secs / 60);
+    secs %= 60;
+
+    RIA.addr0 = text_message_addr + (y * 80 + x) * 3;
+    RIA.step0 = 1;
+    RIA.rw0 = '0' + mins / 10;  RIA.rw0 = HUD_COL_WHITE; RIA.rw0 = HUD_COL_BG;
+    RIA.rw0 = '0' + mins % 10;  RIA.rw0 = HUD_COL_WHITE; RIA.rw0 = HUD_COL_BG;
+    RIA.rw0 = ':';              RIA.rw0 = HUD_COL_CYAN;  RIA.rw0 = HUD_COL_BG;
+    RIA.rw0 = '0' + secs / 10;  RIA.rw0 = HUD_COL_WHITE; RIA.rw0 = HUD_COL_BG;
+    RIA.rw0 = '0' + secs % 10;  RIA.rw0 = HUD_COL_WHITE; RIA.rw0 = HUD_COL_BG;
+}
+
+// Elapsed / total play time. The total only moves with tempo, song
+// length or mode, so per-row updates skip it.
+void draw_song_time(bool with_total) {
+    draw_time(28, 9, song_elapsed_ticks());
+    if (with_total) draw_time(34, 9, song_total_ticks());
+}
+
+// Engine frames missed so far, saturating at FF
+void draw_missed_frames(void) {
+    uint16_t missed = engine_missed_frames;
+    draw_hex_byte_coloured(text_message_addr + (9 * 80 + 47) * 3,
+                           missed > 0xFF ? 0xFF : (uint8_t)missed,
+                           missed ? HUD_COL_RED : HUD_COL_WHITE, HUD_COL_BG);
+}
+
 void update_dashboard(void) {
     const OPL_Patch* p = &gm_bank[current_instrument];
 
@@ -506,6 +578,8 @@ void update_dashboard(void) {
     
     // BPM Value (row 9, col 7-9) - Display in DECIMAL
     draw_decimal_byte_coloured(text_message_addr + (9 * 80 + 7) * 3, seq.bpm, HUD_COL_WHITE, HUD_COL_BG);
+    draw_song_time(true);
+    draw_missed_frames();
     
     // Record State: ON (Red) or OFF (Green)
     draw_string(74, 3, edit_mode ? "ON " : "OFF", edit_mode ? HUD_COL_RED : HUD_COL_GREEN, HUD_COL_BG);
@@ -564,7 +638,25 @@ void draw_meter(uint8_t x, uint8_t y, uint8_t val) {
 }
 
 void update_meters(void) {
-    for (uint8_t i = 0; i < 9; i++) {
+    static uint16_t drawn_mask = CHANNEL_MASK_ALL;
+    uint16_t mask = channel_mask;
+
+    // Muted channels are drawn once, greyed out, when the mask changes
+    if (mask != drawn_mask) {
+        for (uint8_t i = 0; i < 9; i++) {
+            if (mask & (1u << i)) continue;
+            draw_string(57, 10 + i, "CH", HUD_COL_DARKGREY, HUD_COL_BG);
+            RIA.addr0 = text_message_addr + ((10 + i) * 80 + 59) * 3;
+            RIA.step0 = 1;
+            RIA.rw0 = '0' + i; RIA.rw0 = HUD_COL_DARKGREY; RIA.rw0 = HUD_COL_BG;
+            draw_meter(61, 10 + i, 0);
+        }
+        drawn_mask = mask;
+    }
+
+    for (uint8_t i = 0; i < 9; i++, mask >>= 1) {
+        if (!(mask & 1)) continue;
+
         // Underflow protection: 1-frame decay
         if (ch_peaks[i] > 1) ch_peaks[i]-=2; 
         
@@ -27,13 +27,19 @@ extern uint8_t last_p_row;
 
 extern void write_cell(uint8_t pat, uint8_t row, uint8_t chan, PatternCell *cell);
 extern void render_grid(void);
+// Redraw the grid a slice per frame from the UI task (render_grid_step)
+extern void render_grid_deferred(void);
+extern bool render_grid_step(void);
 extern void update_cursor_visuals(uint8_t old_row, uint8_t new_row, uint8_t old_ch, uint8_t new_ch);
 extern void draw_headers(void);
 extern void draw_ui_dashboard(void);
 extern void clear_top_ui(void);
 extern void update_dashboard(void);
+extern void draw_song_time(bool with_total);
+extern void draw_missed_frames(void);
 extern void render_row(uint8_t pattern_row_idx);
 extern void read_cell(uint8_t pat, uint8_t row, uint8_t chan, PatternCell *cell);
+extern void read_row(uint8_t pat, uint8_t row, PatternCell *cells);
 extern void draw_string(uint8_t x, uint8_t y, const char* s, uint8_t fg, uint8_t bg);
 extern void draw_hex_byte(uint16_t vga_addr, uint8_t val);
 extern void draw_hex_byte_coloured(uint16_t vga_addr, uint8_t val, uint8_t fg, uint8_t bg);
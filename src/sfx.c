@@ -0,0 +1,167 @@
+#include <rp6502.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sfx.h"
+#include "engine.h"
+#include "player.h"
+#include "screen.h"
+#include "effects.h"
+#include "instruments.h"
+#include "opl.h"
+
+static SfxPlayer sfx[SFX_PLAYERS];
+uint16_t sfx_held = 0;
+
+// What the music had on a channel when an SFX took it
+typedef struct {
+    OPL_Patch patch;
+    uint8_t a0;
+    uint8_t b0;
+} SfxSavedVoice;
+
+static SfxSavedVoice saved_voice[9];
+
+bool sfx_play(uint8_t pattern, uint8_t priority) {
+    // Find the channels it uses and where it ends
+    PatternCell cells[9];
+    uint16_t channels = 0;
+    uint8_t last_row = 0;
+
+    for (uint8_t row = 0; row < 32; row++) {
+        read_row(pattern, row, cells);
+        for (uint8_t ch = 0; ch < 9; ch++) {
+            if (cells[ch].note != 0 || cells[ch].effect != 0) {
+                channels |= (1u << ch);
+                last_row = row;
+            }
+        }
+    }
+    if (!channels) return false;
+
+    for (uint8_t i = 0; i < SFX_PLAYERS; i++) {
+        SfxPlayer *p = &sfx[i];
+        if (p->state != SFX_IDLE) continue;
+
+        p->pattern = pattern;
+        p->priority = priority;
+        p->channels = channels;
+        p->last_row = last_row;
+        p->state = SFX_QUEUED;
+
+        if (engine_post(ENGINE_CMD_SFX, i)) return true;
+        p->state = SFX_IDLE;
+        return false;
+    }
+    return false;
+}
+
+// Hand the channels back to the music as it left them
+static void sfx_release(SfxPlayer *p) {
+    uint16_t m = p->channels;
+    sfx_held &= ~m;
+
+    for (uint8_t ch = 0; m; ch++, m >>= 1) {
+        if (!(m & 1)) continue;
+
+        effects_reset_channel(ch);
+        OPL_NoteOff(ch);
+
+        SfxSavedVoice *v = &saved_voice[ch];
+        OPL_PatchForget(ch); // Same buffer, new contents
+        OPL_SetPatch(ch, &v->patch);
+        OPL_Write(0xA0 + ch, v->a0);
+        OPL_Write(0xB0 + ch, v->b0 & 0x1F); // Key off
+        shadow_b0[ch] = v->b0 & 0x1F;
+        ch_peaks[ch] = 0;
+
+        sequencer_rejoin_channel(ch);
+    }
+
+    p->state = SFX_IDLE;
+}
+
+void sfx_start(uint8_t slot) {
+    SfxPlayer *p = &sfx[slot];
+    if (p->state != SFX_QUEUED) return;
+
+    // Voice priority: refuse if a higher priority SFX holds any channel...
+    for (uint8_t i = 0; i < SFX_PLAYERS; i++) {
+        SfxPlayer *q = &sfx[i];
+        if (q->state == SFX_PLAYING && (q->channels & p->channels) &&
+            q->priority > p->priority) {
+            p->state = SFX_IDLE;
+            return;
+        }
+    }
+
+    // ...otherwise take them over
+    for (uint8_t i = 0; i < SFX_PLAYERS; i++) {
+        SfxPlayer *q = &sfx[i];
+        if (q->state == SFX_PLAYING && (q->channels & p->channels)) {
+            sfx_release(q);
+        }
+    }
+
+    uint16_t m = p->channels;
+    for (uint8_t ch = 0; m; ch++, m >>= 1) {
+        if (!(m & 1)) continue;
+
+        SfxSavedVoice *v = &saved_voice[ch];
+        OPL_GetPatch(ch, &v->patch);
+        v->a0 = opl_hardware_shadow[0xA0 + ch];
+        v->b0 = opl_hardware_shadow[0xB0 + ch];
+
+        effects_reset_channel(ch);
+        OPL_NoteOff(ch);
+        sequencer_rejoin_channel(ch); // The SFX parses its first effect fresh
+    }
+    sfx_held |= p->channels;
+
+    // Row 0 plays on the next step
+    p->row = 0;
+    p->tick_counter_fp = seq.ticks_per_row_fp;
+    p->state = SFX_PLAYING;
+}
+
+void sfx_step(void) {
+    if (!sfx_held) return;
+
+    for (uint8_t i = 0; i < SFX_PLAYERS; i++) {
+        SfxPlayer *p = &sfx[i];
+        if (p->state != SFX_PLAYING) continue;
+
+        p->tick_counter_fp += TICK_SCALE;
+        if (p->tick_counter_fp < seq.ticks_per_row_fp) continue;
+        p->tick_counter_fp -= seq.ticks_per_row_fp;
+
+        if (p->row > p->last_row) {
+            sfx_release(p);
+            continue;
+        }
+
+        PatternCell cells[9];
+        read_row(p->pattern, p->row++, cells);
+        fx_row_start |= p->channels;
+
+        uint16_t m = p->channels & channel_mask;
+        for (uint8_t ch = 0; m; ch++, m >>= 1) {
+            if (!(m & 1)) continue;
+            if (cells[ch].note != 0 || cells[ch].effect != 0) {
+                sequencer_play_cell(ch, &cells[ch]);
+            } else {
+                sequencer_empty_cell(ch);
+            }
+        }
+    }
+
+    // The music runs every channel's effects while it plays; otherwise
+    // the held ones are ours to run
+    if (!seq.is_playing) sequencer_run_effects(sfx_held & channel_mask);
+}
+
+void sfx_reset(void) {
+    for (uint8_t i = 0; i < SFX_PLAYERS; i++) {
+        sfx[i].state = SFX_IDLE;
+    }
+    sfx_held = 0;
+}
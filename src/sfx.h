@@ -0,0 +1,51 @@
+#ifndef SFX_H
+#define SFX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// SOUND EFFECT PLAYERS
+// ============================================================================
+// Short patterns played over the music, for games. An SFX plays its
+// pattern from row 0 to the last non-empty row, at the music's tempo, on
+// the channels it has notes or effects on. While it plays it holds those
+// channels: the music sequencer skips them and the SFX drives them through
+// the same cell and effect code. On release the channel gets back the
+// patch and pitch the music had there, and the music carries on from its
+// next cell.
+//
+// A new SFX takes its channels from playing SFX of the same or lower
+// priority, which are released first, and is refused if a higher
+// priority one holds any of them.
+
+#define SFX_PLAYERS 2
+
+#define SFX_IDLE    0
+#define SFX_QUEUED  1   // Set up by sfx_play(), waiting for the engine
+#define SFX_PLAYING 2
+
+typedef struct {
+    volatile uint8_t state;     // UI: IDLE -> QUEUED, engine: the rest
+    uint8_t priority;
+    uint8_t pattern;
+    uint8_t row;                // Next row to play
+    uint8_t last_row;
+    uint16_t channels;          // Channels it holds while playing
+    uint16_t tick_counter_fp;   // 8.8, like seq.tick_counter_fp
+} SfxPlayer;
+
+// Channels held by playing SFX. Written by the engine only.
+extern uint16_t sfx_held;
+
+// Queue a pattern as a sound effect (UI/game side). Returns false if the
+// pattern is empty or every player is busy.
+extern bool sfx_play(uint8_t pattern, uint8_t priority);
+
+// Engine side: ENGINE_CMD_SFX, once per tick before sequencer_step(),
+// and drop everything (song load, rewind, panic)
+extern void sfx_start(uint8_t slot);
+extern void sfx_step(void);
+extern void sfx_reset(void);
+
+#endif // SFX_H
@@ -11,6 +11,10 @@
 #include "input.h"
 #include <string.h>
 #include "usb_hid_keys.h"
+#include "stream.h"
+#include "engine.h"
+#include "sfx.h"
+#include "effects.h"
 
 uint8_t cur_order_idx = 0; // Where we are in the playlist
 uint16_t song_length = 1;   // Total number of patterns in the song
@@ -95,6 +99,15 @@ void save_song(const char* filename) {
     // Save the 256-step Sequence Order (at $B400)
     write_xram(0xB400, 0x0100, fd);
 
+    // Song arp tables, an optional chunk older versions stop short of
+    write(fd, "ARP1", 4);
+    write(fd, song_arp_len, sizeof(song_arp_len));
+    write(fd, song_arp_steps, sizeof(song_arp_steps));
+
+    // Generator seed, likewise optional
+    write(fd, "SEED", 4);
+    write(fd, &song_gen_seed, 2);
+
     close(fd);
 }
 
@@ -118,9 +131,31 @@ void load_song(const char* filename) {
     read(fd, &song_length, 2);
 
     // 2. Load bulk data directly into XRAM
+    // The engine must not play a half-loaded song
+    engine_hold = true;
     read_xram(0x0000, 0xB400, fd); // Patterns
     read_xram(0xB400, 0x0100, fd); // Sequence List
 
+    // Optional chunks, in the order they were added: songs from older
+    // versions stop short and keep the defaults
+    memset(song_arp_len, 0, sizeof(song_arp_len));
+    song_gen_seed = GEN_DEFAULT_SEED;
+    while (read(fd, head, 4) == 4) {
+        if (memcmp(head, "ARP1", 4) == 0) {
+            read(fd, song_arp_len, sizeof(song_arp_len));
+            read(fd, song_arp_steps, sizeof(song_arp_steps));
+            for (uint8_t i = 0; i < SONG_ARP_TABLES; i++) {
+                if (song_arp_len[i] > ARP_MAX_STEPS) song_arp_len[i] = 0;
+            }
+        } else if (memcmp(head, "SEED", 4) == 0) {
+            read(fd, &song_gen_seed, 2);
+        } else {
+            break;
+        }
+    }
+    stream_invalidate_all();        // Compiled patterns are stale now
+    sfx_reset();                    // So are any sound effects
+
     close(fd); // Close file immediately after reading
 
     // 3. UPDATE LOGICAL STATE BEFORE UI REFRESH
@@ -129,6 +164,7 @@ void load_song(const char* filename) {
     cur_order_idx = 0;
     cur_pattern = read_order_xram(0); 
     cur_row = 0;
+    engine_hold = false;
 
     // 4. SYNC GLOBALS
     strncpy(active_filename, filename, 12);
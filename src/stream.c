@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stream.h"
+#include "screen.h"
+
+// Double buffer: the playing pattern and the one being prefetched
+static PatternStream stream_buf[2];
+static PatternStream *stream_cur = &stream_buf[0];
+static PatternStream *stream_next = &stream_buf[1];
+static bool stream_ready = false;
+
+static void stream_begin(PatternStream *s, uint8_t pat) {
+    s->pattern = pat;
+    s->cursor = 0;
+    memset(s->count, STREAM_ROW_PENDING, sizeof(s->count));
+}
+
+static void stream_init(void) {
+    stream_begin(&stream_buf[0], STREAM_NO_PATTERN);
+    stream_begin(&stream_buf[1], STREAM_NO_PATTERN);
+    stream_ready = true;
+}
+
+// Keep only cells with a note or an effect. Empty cells are left out;
+// the sequencer clears the effect shadow for those from the row mask.
+static void stream_compile_row(PatternStream *s, uint8_t row) {
+    PatternCell cells[9];
+    PatternEvent *e = s->ev[row];
+    uint8_t n = 0;
+    uint16_t mask = 0;
+
+    read_row(s->pattern, row, cells);
+
+    for (uint8_t ch = 0; ch < 9; ch++) {
+        if (cells[ch].note != 0 || cells[ch].effect != 0) {
+            e->ch = ch;
+            e->cell = cells[ch];
+            e++;
+            n++;
+            mask |= (1u << ch);
+        }
+    }
+
+    s->count[row] = n;
+    s->mask[row] = mask;
+}
+
+const PatternStream *stream_get(uint8_t pat, uint8_t row) {
+    if (!stream_ready) stream_init();
+
+    if (stream_cur->pattern != pat) {
+        if (stream_next->pattern == pat) {
+            // Pattern boundary: the prefetched buffer becomes the playing one
+            PatternStream *t = stream_cur;
+            stream_cur = stream_next;
+            stream_next = t;
+        } else {
+            // Jumped somewhere unexpected, compile rows as they are reached
+            stream_begin(stream_cur, pat);
+        }
+    }
+
+    if (stream_cur->count[row] == STREAM_ROW_PENDING) {
+        stream_compile_row(stream_cur, row);
+    }
+    return stream_cur;
+}
+
+void stream_lookahead(uint8_t pat, uint8_t row) {
+    if (!stream_ready) stream_init();
+
+    // Only the playing buffer; stream_get() deals with pattern changes
+    if (stream_cur->pattern != pat) return;
+    if (stream_cur->count[row] == STREAM_ROW_PENDING) {
+        stream_compile_row(stream_cur, row);
+    }
+}
+
+void stream_prefetch(uint8_t pat) {
+    if (!stream_ready) stream_init();
+
+    // Repeating the same pattern: the playing buffer already covers it
+    if (stream_cur->pattern == pat) return;
+
+    if (stream_next->pattern != pat) stream_begin(stream_next, pat);
+
+    uint8_t budget = STREAM_ROWS_PER_TICK;
+    while (budget && stream_next->cursor < STREAM_ROWS) {
+        uint8_t row = stream_next->cursor++;
+        if (stream_next->count[row] == STREAM_ROW_PENDING) {
+            stream_compile_row(stream_next, row);
+            budget--;
+        }
+    }
+}
+
+void stream_invalidate_row(uint8_t pat, uint8_t row) {
+    if (stream_buf[0].pattern == pat) stream_buf[0].count[row] = STREAM_ROW_PENDING;
+    if (stream_buf[1].pattern == pat) stream_buf[1].count[row] = STREAM_ROW_PENDING;
+}
+
+void stream_invalidate(uint8_t pat) {
+    if (stream_buf[0].pattern == pat) stream_begin(&stream_buf[0], pat);
+    if (stream_buf[1].pattern == pat) stream_begin(&stream_buf[1], pat);
+}
+
+void stream_invalidate_all(void) {
+    stream_init();
+}
@@ -0,0 +1,50 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "screen.h"
+
+// ============================================================================
+// PATTERN EVENT STREAM
+// ============================================================================
+// A pattern compiled into per-row lists of its non-empty cells, so the
+// sequencer only touches channels that actually have something on a row.
+
+#define STREAM_ROWS          32
+#define STREAM_ROW_PENDING   0xFF  // count[] marker: row not compiled yet
+#define STREAM_NO_PATTERN    0xFF
+
+// Start compiling the next pattern once playback reaches this row...
+#define STREAM_PREFETCH_ROW  24
+// ...at this many rows per idle (non-row) frame.
+#define STREAM_ROWS_PER_TICK 2
+
+typedef struct {
+    uint8_t ch;
+    PatternCell cell;
+} PatternEvent;
+
+typedef struct {
+    uint8_t pattern;                  // Pattern compiled into this buffer
+    uint8_t cursor;                   // Next row for incremental compile
+    uint8_t count[STREAM_ROWS];       // Events per row (or STREAM_ROW_PENDING)
+    uint16_t mask[STREAM_ROWS];       // Bit per channel with an event on the row
+    PatternEvent ev[STREAM_ROWS][9];
+} PatternStream;
+
+// Stream for a row of the playing pattern, compiling on demand if needed
+extern const PatternStream *stream_get(uint8_t pat, uint8_t row);
+
+// Compile one upcoming row of the playing pattern (idle frames only)
+extern void stream_lookahead(uint8_t pat, uint8_t row);
+
+// Compile a few rows of the pattern that will play next (idle frames only)
+extern void stream_prefetch(uint8_t pat);
+
+// Pattern data changed in XRAM: drop the affected compiled rows
+extern void stream_invalidate_row(uint8_t pat, uint8_t row);
+extern void stream_invalidate(uint8_t pat);
+extern void stream_invalidate_all(void);
+
+#endif // STREAM_H
@@ -0,0 +1,88 @@
+// With OPL_DEFER_WRITES, a frame's register writes go out at its end in
+// four groups: key-offs, then patches and levels, then F-numbers, then
+// block and key-on. A note struck again in the same frame it was keyed
+// off must still reach the chip as a key-off followed by a key-on, or
+// its envelope doesn't restart.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "host.h"
+#include "player.h"
+#include "screen.h"
+#include "song.h"
+#include "engine.h"
+
+#define TICKS 36 // Six rows at the default 150 BPM
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static void put(uint8_t row, uint8_t ch, uint8_t note, uint8_t inst, uint16_t effect) {
+    PatternCell c = { note, inst, 63, effect };
+    write_cell(0, row, ch, &c);
+}
+
+static bool is_b0(uint8_t reg) { return reg >= 0xB0 && reg <= 0xB8; }
+static bool is_a0(uint8_t reg) { return reg >= 0xA0 && reg <= 0xA8; }
+
+int main(void) {
+    host_init();
+
+    // Channel 0: a new note and patch on every row, each struck over the
+    // last. Channel 1: one note retriggered every 3 ticks (7003).
+    for (uint8_t row = 0; row < 6; row++) {
+        put(row, 0, 60 + row, row & 1 ? 24 : 0, 0x0000);
+    }
+    put(0, 1, 57, 0, 0x7003);
+
+    engine_post(ENGINE_CMD_PLAY, 0);
+
+    uint8_t restrikes[2] = { 0, 0 };
+    bool order_ok = true;
+
+    for (uint8_t t = 0; t < TICKS; t++) {
+        host_log_start();
+        host_tick();
+        host_log_stop();
+
+        // Where each group starts and ends in this frame's writes
+        int16_t last_off = -1, first_other = -1;
+        int16_t last_patch = -1, first_a0 = -1, last_a0 = -1, first_on = -1;
+        bool off[9] = { false }, on_after_off[9] = { false };
+        for (int16_t i = 0; i < (int16_t)host_log_len; i++) {
+            uint8_t reg = host_log_reg[i];
+            if (is_b0(reg) && !(host_log_val[i] & 0x20)) {
+                last_off = i;
+                off[reg - 0xB0] = true;
+                continue;
+            }
+            if (first_other < 0) first_other = i;
+            if (is_b0(reg)) {
+                if (first_on < 0) first_on = i;
+                if (off[reg - 0xB0]) on_after_off[reg - 0xB0] = true;
+            } else if (is_a0(reg)) {
+                if (first_a0 < 0) first_a0 = i;
+                last_a0 = i;
+            } else {
+                last_patch = i;
+            }
+        }
+
+        if (first_other >= 0 && last_off > first_other) order_ok = false;
+        if (first_a0 >= 0 && last_patch > first_a0) order_ok = false;
+        if (first_on >= 0 && (last_patch > first_on || last_a0 > first_on)) order_ok = false;
+        for (uint8_t ch = 0; ch < 2; ch++) {
+            if (on_after_off[ch]) restrikes[ch]++;
+        }
+    }
+
+    check(restrikes[0] >= 5, "channel 0: every row's strike keys off, then on");
+    check(restrikes[1] >= 10, "channel 1: every retrigger keys off, then on");
+    check(order_ok, "each frame sends key-offs, then patches and levels, F-numbers, key-ons");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+#include <rp6502.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "host.h"
+#include "constants.h"
+#include "engine.h"
+#include "player.h"
+#include "effects.h"
+#include "sfx.h"
+#include "opl.h"
+#include "instruments.h"
+
+// --- <rp6502.h> ---
+
+uint8_t xram[0x10000];
+
+static uint8_t *port0(void) {
+    uint8_t *p = &xram[RIA.addr0];
+    RIA.addr0 += RIA.step0;
+    return p;
+}
+
+// OPL register writes, in order, between host_log_start() and
+// host_log_stop(). An access is logged when the next one comes, by which
+// time the byte has been stored.
+uint8_t host_log_reg[HOST_LOG_MAX];
+uint8_t host_log_val[HOST_LOG_MAX];
+uint16_t host_log_len = 0;
+
+static bool log_on = false;
+static bool log_pending = false;
+static uint16_t log_addr;
+
+static void log_take(void) {
+    if (log_pending && host_log_len < HOST_LOG_MAX) {
+        host_log_reg[host_log_len] = (uint8_t)(log_addr - OPL_ADDR);
+        host_log_val[host_log_len] = xram[log_addr];
+        host_log_len++;
+    }
+    log_pending = false;
+}
+
+static uint8_t *port1(void) {
+    log_take();
+    if (log_on && RIA.addr1 >= OPL_ADDR && RIA.addr1 <= OPL_ADDR + 0xFF) {
+        log_pending = true;
+        log_addr = RIA.addr1;
+    }
+    uint8_t *p = &xram[RIA.addr1];
+    RIA.addr1 += RIA.step1;
+    return p;
+}
+
+struct __RP6502 RIA = { .port0 = port0, .port1 = port1 };
+
+int xregn(char device, char channel, unsigned char address, unsigned count, ...) { return 0; }
+// The only file written is an export, which goes to host_export[]
+#define HOST_EXPORT_FD 3
+
+uint8_t host_export[HOST_EXPORT_MAX];
+uint32_t host_export_len = 0;
+
+int host_open(const char *path, int oflag) {
+    if (!(oflag & O_CREAT)) return -1;
+    host_export_len = 0;
+    return HOST_EXPORT_FD;
+}
+
+int host_close(int fildes) { return 0; }
+
+int read_xram(unsigned buf, unsigned count, int fildes) { return -1; }
+
+int write_xram(unsigned buf, unsigned count, int fildes) {
+    if (fildes != HOST_EXPORT_FD || host_export_len + count > HOST_EXPORT_MAX) return -1;
+    for (unsigned i = 0; i < count; i++) {
+        host_export[host_export_len++] = xram[(uint16_t)(buf + i)];
+    }
+    return count;
+}
+int read_xstack(void *buf, unsigned count, int fildes) { return -1; }
+int phi2(void) { return 8000; }
+
+// --- main.c ---
+
+unsigned text_message_addr = 0xC000;
+
+// --- engine.c ---
+
+volatile uint8_t engine_events = 0;
+bool engine_headless = false;
+volatile uint16_t engine_missed_frames = 0;
+volatile bool engine_hold = false;
+
+static EngineCmd cmd_queue[ENGINE_CMD_SLOTS];
+static uint8_t cmd_count = 0;
+
+bool engine_post(uint8_t cmd, uint8_t arg) {
+    if (cmd_count == ENGINE_CMD_SLOTS) return false;
+    cmd_queue[cmd_count].cmd = cmd;
+    cmd_queue[cmd_count].arg = arg;
+    cmd_count++;
+    return true;
+}
+
+uint8_t engine_take_events(void) {
+    uint8_t ev = engine_events;
+    engine_events = 0;
+    return ev;
+}
+
+void engine_init(void) {}
+void engine_shutdown(void) {}
+
+static void host_run_commands(void) {
+    for (uint8_t i = 0; i < cmd_count; i++) {
+        EngineCmd *c = &cmd_queue[i];
+        switch (c->cmd) {
+            case ENGINE_CMD_PLAY:  sequencer_play();  break;
+            case ENGINE_CMD_PAUSE: sequencer_pause(); break;
+            case ENGINE_CMD_STOP:  sequencer_stop();  break;
+            case ENGINE_CMD_TEMPO:
+                seq.bpm = c->arg;
+                bpm_to_ticks_fp(seq.bpm);
+                break;
+            case ENGINE_CMD_SFX:   sfx_start(c->arg); break;
+        }
+    }
+    cmd_count = 0;
+}
+
+// --- host.h ---
+
+void host_init(void) {
+    OPL_Config(1, OPL_ADDR);
+    OPL_Init();
+    bpm_to_ticks_fp(seq.bpm);
+    gen_seed();
+    for (uint8_t i = 0; i < 9; i++) {
+        OPL_SetPatch(i, &gm_bank[0]);
+    }
+}
+
+void host_tick(void) {
+    host_run_commands();
+    sfx_step();
+    sequencer_step();
+    OPL_Flush();
+}
+
+uint8_t host_opl(uint8_t reg) {
+    return xram[OPL_ADDR + reg];
+}
+
+void host_log_start(void) {
+    host_log_len = 0;
+    log_pending = false;
+    log_on = true;
+}
+
+void host_log_stop(void) {
+    log_take();
+    log_on = false;
+}
@@ -0,0 +1,37 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+// ============================================================================
+// TEST HOST
+// ============================================================================
+// engine.c is the 6502 IRQ and doesn't build on the host, so the tests
+// drive the engine themselves: commands posted with engine_post() are
+// queued here and applied by host_tick(), which then runs one engine
+// tick the way the IRQ does.
+
+// Chip, shadows, patches and tempo as main() leaves them at boot
+extern void host_init(void);
+
+// One engine tick: queued commands, SFX players, sequencer, OPL flush
+extern void host_tick(void);
+
+// An OPL register as last written to the chip
+extern uint8_t host_opl(uint8_t reg);
+
+// OPL register writes as they reached the chip, in order, from
+// host_log_start() to host_log_stop()
+#define HOST_LOG_MAX 1024
+extern uint8_t host_log_reg[HOST_LOG_MAX];
+extern uint8_t host_log_val[HOST_LOG_MAX];
+extern uint16_t host_log_len;
+extern void host_log_start(void);
+extern void host_log_stop(void);
+
+// The last export_song(), as it would be on disk
+#define HOST_EXPORT_MAX 0x10000
+extern uint8_t host_export[HOST_EXPORT_MAX];
+extern uint32_t host_export_len;
+
+#endif // HOST_H
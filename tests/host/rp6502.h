@@ -0,0 +1,57 @@
+#ifndef RP6502_H
+#define RP6502_H
+
+// Host stand-in for the llvm-mos SDK's <rp6502.h>, for the tests only.
+// XRAM is a plain array and the portals read and write it through their
+// addr/step registers, so the engine code builds unchanged. With
+// USE_NATIVE_OPL2 the OPL registers land in XRAM at OPL_ADDR, as on the
+// RIA, where a test can read them back. Files aren't opened: an export
+// lands in host_export[] (host.h) instead.
+
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+struct __RP6502 {
+    uint8_t *(*port0)(void);
+    int8_t step0;
+    uint16_t addr0;
+    uint8_t *(*port1)(void);
+    int8_t step1;
+    uint16_t addr1;
+    uint8_t irq;
+    uint8_t vsync;
+};
+
+extern struct __RP6502 RIA;
+
+// RIA.rw0 / RIA.rw1: the byte at addr, which then moves on by step
+#define rw0 port0()[0]
+#define rw1 port1()[0]
+
+extern uint8_t xram[0x10000];
+
+int xregn(char device, char channel, unsigned char address, unsigned count, ...);
+#define xreg(device, channel, address, ...) \
+    xregn(device, channel, address, 1, __VA_ARGS__)
+
+typedef struct {
+    uint8_t x_wrap, y_wrap;
+    int16_t x_pos_px, y_pos_px;
+    int16_t width_chars, height_chars;
+    uint16_t xram_data_ptr, xram_palette_ptr, xram_font_ptr;
+} vga_mode1_config_t;
+
+#define xram0_struct_set(addr, type, member, val) ((void)(val))
+
+int host_open(const char *path, int oflag);
+int host_close(int fildes);
+#define open(path, oflag) host_open(path, oflag)
+#define close(fildes) host_close(fildes)
+
+int read_xram(unsigned buf, unsigned count, int fildes);
+int write_xram(unsigned buf, unsigned count, int fildes);
+int read_xstack(void *buf, unsigned count, int fildes);
+int phi2(void);
+
+#endif // RP6502_H
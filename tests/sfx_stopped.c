@@ -0,0 +1,88 @@
+// An SFX auditioned with the music stopped runs its effects on its own
+// row clock: the row's note sounds as written on tick 0, then vibrato
+// moves the pitch and portamento slides it on every tick but a row's
+// first, the same as under the music.
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "host.h"
+#include "player.h"
+#include "screen.h"
+#include "sfx.h"
+#include "opl.h"
+
+#define SFX_PATTERN 5
+#define TICKS_PER_ROW 6 // At the default 150 BPM
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static void put(uint8_t row, uint8_t ch, uint8_t note, uint16_t effect) {
+    PatternCell c = { note, 0, 63, effect };
+    write_cell(SFX_PATTERN, row, ch, &c);
+}
+
+// Block and F-number as one number that rises with the pitch
+static uint16_t pitch_of(uint8_t ch) {
+    return ((uint16_t)(host_opl(0xB0 + ch) & 0x1F) << 8) | host_opl(0xA0 + ch);
+}
+
+static uint16_t note_pitch(uint8_t note) {
+    return ((uint16_t)opl_fnum_hi[note] << 8) | opl_fnum_lo[note];
+}
+
+int main(void) {
+    host_init();
+
+    // Channel 0: A-4 with vibrato 48F0, and the effect again on row 3 so
+    // the SFX lasts four rows. Channel 1: C-3 sliding up an octave, one
+    // semitone a frame (2210).
+    put(0, 0, 69, 0x48F0);
+    put(0, 1, 48, 0x2210);
+    put(3, 0, 0, 0x48F0);
+
+    check(!seq.is_playing, "music is stopped");
+    check(sfx_play(SFX_PATTERN, 1), "SFX queued");
+
+    host_tick();
+    check(sfx_held == 0x0003, "SFX holds channels 0 and 1");
+    check(host_opl(0xB0) & 0x20, "vibrato note keyed on");
+    check(host_opl(0xB1) & 0x20, "slide note keyed on");
+    check(pitch_of(0) == note_pitch(69), "tick 0 plays the vibrato note as written");
+    check(pitch_of(1) == note_pitch(48), "tick 0 plays the slide's first note");
+
+    uint16_t vib_lo = pitch_of(0), vib_hi = pitch_of(0);
+    uint16_t slide = pitch_of(1);
+    bool slide_ok = true;
+
+    for (uint8_t t = 1; t < 12; t++) {
+        host_tick();
+
+        uint16_t p = pitch_of(0);
+        if (p < vib_lo) vib_lo = p;
+        if (p > vib_hi) vib_hi = p;
+
+        // Holds on the first tick of rows 1 and 2, steps on all others.
+        // Like the music's, the player's clock starts at the end of a row,
+        // so its row 0 is a tick short.
+        bool row_start = (t + 1) % TICKS_PER_ROW == 0;
+        if (row_start ? pitch_of(1) != slide : pitch_of(1) <= slide)
+            slide_ok = false;
+        slide = pitch_of(1);
+    }
+
+    check(vib_lo < note_pitch(69) && vib_hi > note_pitch(69),
+          "vibrato swings the pitch both ways");
+    check(slide_ok, "portamento steps on every tick but the row's first");
+    check(slide == note_pitch(48 + 9), "portamento reached A-3 after 11 ticks");
+
+    // Played out: the channels go back to the music
+    for (uint8_t t = 0; t < 24; t++) host_tick();
+    check(sfx_held == 0, "SFX released its channels");
+
+    return failures ? 1 : 0;
+}
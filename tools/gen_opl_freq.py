@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+OPL2 note table generator.
+Writes opl_freq.c for one OPL clock: the A0/B0 register values for every
+MIDI note, plus the F-number step to the next semitone for fine pitch,
+and the highest note the chip can play in tune.
+Run by CMake; the clock comes from USE_NATIVE_OPL2.
+
+Usage: gen_opl_freq.py <clock_hz> <out.c>
+"""
+
+import sys
+
+NOTES = 128
+A4_NOTE = 69
+A4_HZ = 440.0
+FNUM_MAX = 1023
+
+
+def note_hz(note):
+    return A4_HZ * 2.0 ** ((note - A4_NOTE) / 12.0)
+
+
+def block_of(note):
+    # Block 0 holds C-1 and everything below it, block 7 everything from C-8 up
+    return min(max((note - 12) // 12, 0), 7)
+
+
+def fnum(note, block, clock_hz):
+    # f = fnum * (clock / 72) / 2^(20 - block)
+    f = round(note_hz(note) * (1 << (20 - block)) / (clock_hz / 72.0))
+    return min(f, FNUM_MAX)
+
+
+def note_max(clock_hz):
+    # Past this the F-number is clamped, so every note up there is one pitch
+    n = NOTES - 1
+    while round(note_hz(n) * (1 << (20 - block_of(n))) / (clock_hz / 72.0)) > FNUM_MAX:
+        n -= 1
+    return n
+
+
+def build(clock_hz):
+    lo, hi, step = [], [], []
+    for n in range(NOTES):
+        b = block_of(n)
+        f = fnum(n, b, clock_hz)
+        # The next semitone in this note's block, so interpolation never
+        # has to change block
+        f_next = fnum(n + 1, b, clock_hz)
+        lo.append(f & 0xFF)
+        hi.append((b << 2) | (f >> 8))
+        step.append(f_next - f)
+    assert all(0 <= s <= 0xFF for s in step)
+    assert all(s > 0 for s in step[:note_max(clock_hz) + 1])
+    return lo, hi, step
+
+
+def c_table(name, values):
+    rows = []
+    for i in range(0, len(values), 12):
+        rows.append("    " + ", ".join(f"{v:3d}" for v in values[i:i + 12]) + ",")
+    return f"const uint8_t {name}[{len(values)}] = {{\n" + "\n".join(rows) + "\n};\n"
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip().splitlines()[-1])
+        sys.exit(1)
+
+    clock_hz = int(sys.argv[1])
+    lo, hi, step = build(clock_hz)
+
+    with open(sys.argv[2], "w") as f:
+        f.write(f"// Generated by tools/gen_opl_freq.py for a {clock_hz} Hz OPL2. Do not edit.\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write("// A0: F-number low bits\n")
+        f.write(c_table("opl_fnum_lo", lo))
+        f.write("\n// B0 without the key bit: block << 2 | F-number high bits\n")
+        f.write(c_table("opl_fnum_hi", hi))
+        f.write("\n// F-number step to the next semitone, in the note's own block\n")
+        f.write(c_table("opl_fine_step", step))
+        f.write("\n// Highest note with its own F-number\n")
+        f.write(f"const uint8_t opl_note_max = {note_max(clock_hz)};\n")
+
+
+if __name__ == "__main__":
+    main()
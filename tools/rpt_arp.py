@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""
+RPTracker song arp tables.
+Lists or edits the arp tables of an RPT2 song (its ARP1 chunk), played
+with effect command B. A table is up to 16 steps, each a number of
+semitones above the root, or D for the effect's depth nibble. A song
+without the chunk gets one; everything else in the file is kept.
+
+Usage: rpt_arp.py <song.rpt> [<table 0-7> <step>... | <table 0-7> clear]
+"""
+
+import sys
+
+HEADER_SIZE = 8               # "RPT2", octave, volume, song length
+BODY_SIZE = 0xB400 + 0x100    # Patterns, then the order list
+TABLES = 8
+MAX_STEPS = 16
+ARP_DEPTH = 0xFF              # Step that plays the D nibble
+CHUNK_SIZES = {b"ARP1": TABLES + TABLES * MAX_STEPS, b"SEED": 2}
+
+
+def read_song(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"RPT2":
+        sys.exit(f"Error: {path} is not an RPT2 song")
+    if len(data) < HEADER_SIZE + BODY_SIZE:
+        # Chunks after a short body would load as pattern data
+        sys.exit(f"Error: {path} is from an older version, save it from the tracker first")
+
+    # Optional chunks, as load_song() reads them: stop at anything unknown
+    # and keep it as it is
+    chunks = {}
+    pos = HEADER_SIZE + BODY_SIZE
+    while pos + 4 <= len(data) and data[pos:pos + 4] in CHUNK_SIZES:
+        tag = data[pos:pos + 4]
+        size = CHUNK_SIZES[tag]
+        chunks[tag] = data[pos + 4:pos + 4 + size].ljust(size, b"\x00")
+        pos += 4 + size
+    return data[:HEADER_SIZE + BODY_SIZE], chunks, data[pos:]
+
+
+def write_song(path, song, chunks, rest):
+    with open(path, "wb") as f:
+        f.write(song)
+        for tag in CHUNK_SIZES:  # Same order as save_song()
+            if tag in chunks:
+                f.write(tag + chunks[tag])
+        f.write(rest)
+
+
+def get_tables(chunks):
+    raw = chunks.get(b"ARP1", bytes(CHUNK_SIZES[b"ARP1"]))
+    tables = []
+    for n in range(TABLES):
+        length = raw[n] if raw[n] <= MAX_STEPS else 0
+        start = TABLES + n * MAX_STEPS
+        tables.append(list(raw[start:start + length]))
+    return tables
+
+
+def set_tables(chunks, tables):
+    raw = bytearray(CHUNK_SIZES[b"ARP1"])
+    for n, steps in enumerate(tables):
+        raw[n] = len(steps)
+        start = TABLES + n * MAX_STEPS
+        raw[start:start + len(steps)] = bytes(steps)
+    chunks[b"ARP1"] = bytes(raw)
+
+
+def parse_step(text):
+    if text.upper() == "D":
+        return ARP_DEPTH
+    try:
+        step = int(text, 0)
+    except ValueError:
+        sys.exit(f"Error: step '{text}' is not a number or D")
+    if not 0 <= step <= 127:
+        sys.exit(f"Error: step {step} is out of range (0-127)")
+    return step
+
+
+def show(tables):
+    for n, steps in enumerate(tables):
+        text = " ".join("D" if s == ARP_DEPTH else str(s) for s in steps)
+        print(f"B{n}: {text if steps else '(empty)'}")
+
+
+def main():
+    if len(sys.argv) < 2 or len(sys.argv) == 3:
+        print(__doc__.strip().splitlines()[-1])
+        sys.exit(1)
+
+    path = sys.argv[1]
+    song, chunks, rest = read_song(path)
+    tables = get_tables(chunks)
+
+    if len(sys.argv) > 3:
+        n = int(sys.argv[2], 0)
+        if not 0 <= n < TABLES:
+            sys.exit(f"Error: table {n} is out of range (0-{TABLES - 1})")
+        if sys.argv[3].lower() == "clear":
+            tables[n] = []
+        else:
+            steps = [parse_step(s) for s in sys.argv[3:]]
+            if len(steps) > MAX_STEPS:
+                sys.exit(f"Error: {len(steps)} steps, a table holds {MAX_STEPS}")
+            tables[n] = steps
+        set_tables(chunks, tables)
+        write_song(path, song, chunks, rest)
+
+    show(tables)
+
+
+if __name__ == "__main__":
+    main()